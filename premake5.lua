@@ -20,7 +20,7 @@ buildcommands {
 project "SoftwareRenderer"
     includedirs { "libs/include", "libs/GLAD/include", "libs" }
     kind "ConsoleApp"
-    links { "imgui", "Fonts", "GLAD", "glfw", "GL", "dl" }
+    links { "imgui", "Fonts", "GLAD", "glfw", "GL", "dl", "pthread" }
     language "C++"
     cppdialect "C++17"
     targetdir "bin/%{cfg.buildcfg}"
@@ -39,6 +39,18 @@ project "SoftwareRenderer"
         defines { "NDEBUG" }
         optimize "Speed"
 
+project "objToMesh"
+    includedirs { "libs/include", "libs/GLAD/include", "libs" }
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    targetdir "bin/%{cfg.buildcfg}"
+
+    files { "tools/objToMesh/**.cpp", "src/core/meshFile/**.cpp", "src/core/math/**.cpp" }
+
+    filter "configurations:Release"
+        optimize "Speed"
+
 project "imgui"
     kind "StaticLib"
     language "C++"
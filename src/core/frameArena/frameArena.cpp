@@ -0,0 +1,47 @@
+#include "frameArena.hpp"
+#include <algorithm>
+
+FrameArena::FrameArena(size_t capacity)
+{
+    blocks.reserve(8);
+    addBlock(capacity);
+}
+
+void FrameArena::addBlock(size_t size)
+{
+    blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+    offset = 0;
+}
+
+void *FrameArena::allocateBytes(size_t size, size_t alignment)
+{
+    Block *block = &blocks.back();
+    uintptr_t base = (uintptr_t)block->memory.get();
+    size_t start = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+
+    if (start + size > block->size)
+    {
+        addBlock(std::max(block->size * 2, size + alignment));
+        block = &blocks.back();
+        base = (uintptr_t)block->memory.get();
+        start = ((base + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+    }
+
+    offset = start + size;
+    return block->memory.get() + start;
+}
+
+void FrameArena::reset(void)
+{
+    if (blocks.size() > 1)
+    {
+        size_t total = 0;
+        for (auto &block : blocks)
+        {
+            total += block.size;
+        }
+        blocks.clear();
+        addBlock(total);
+    }
+    offset = 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#define FRAME_ARENA_SIZE (1 << 20)
+
+// Linear allocator for buffers that only live for one frame, reset() frees everything at once.
+// If a frame needs more than the block, more blocks are chained and reset() merges them into
+// one, so after the first frames nothing is allocated anymore. Not thread safe.
+class FrameArena
+{
+public:
+    FrameArena(size_t capacity = FRAME_ARENA_SIZE);
+
+    // uninitialised storage for count values, nothing is ever destructed
+    template <typename T>
+    T *allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        return static_cast<T *>(allocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    void reset(void);
+
+private:
+    typedef struct
+    {
+        std::unique_ptr<unsigned char[]> memory;
+        size_t size;
+    } Block;
+
+    std::vector<Block> blocks;
+    size_t offset = 0;
+
+    void *allocateBytes(size_t size, size_t alignment);
+    void addBlock(size_t size);
+};
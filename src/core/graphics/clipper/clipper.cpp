@@ -0,0 +1,92 @@
+#include "clipper.hpp"
+
+// signed distances are dot(plane, vertex), inside is >= 0
+static constexpr float clipPlanes[CLIP_PLANE_COUNT][4] = {
+    {1, 0, 0, 1},  // left: w + x
+    {-1, 0, 0, 1}, // right: w - x
+    {0, 1, 0, 1},  // top: w + y
+    {0, -1, 0, 1}, // bottom: w - y
+    {0, 0, 1, 0},  // near: z
+    {0, 0, -1, 1}, // far: w - z
+    {1, 0, 0, CLIP_GUARD_BAND},
+    {-1, 0, 0, CLIP_GUARD_BAND},
+    {0, 1, 0, CLIP_GUARD_BAND},
+    {0, -1, 0, CLIP_GUARD_BAND},
+};
+
+static inline float planeDistance(int32_t plane, const ClipVertex &vertex)
+{
+    const float *p = clipPlanes[plane];
+    return p[0] * vertex.x + p[1] * vertex.y + p[2] * vertex.z + p[3] * vertex.w;
+}
+
+static inline ClipVertex lerp(const ClipVertex &a, const ClipVertex &b, float t)
+{
+    return {a.x + (b.x - a.x) * t,
+            a.y + (b.y - a.y) * t,
+            a.z + (b.z - a.z) * t,
+            a.w + (b.w - a.w) * t};
+}
+
+uint32_t Clipper::outcode(const ClipVertex &vertex)
+{
+    uint32_t code = 0;
+    for (int32_t plane = 0; plane < CLIP_PLANE_COUNT; plane++)
+    {
+        if (planeDistance(plane, vertex) < 0)
+            code |= 1u << plane;
+    }
+    return code;
+}
+
+void Clipper::clipPolygon(ClipPolygon &polygon, uint32_t planes)
+{
+    ClipVertex buffer[CLIP_MAX_VERTICES];
+    ClipVertex *input = polygon.vertices;
+    ClipVertex *output = buffer;
+    int32_t count = polygon.count;
+
+    for (int32_t plane = 0; plane < CLIP_PLANE_COUNT && count >= 3; plane++)
+    {
+        if (!(planes & (1u << plane)))
+            continue;
+
+        int32_t outputCount = 0;
+        const ClipVertex *previous = &input[count - 1];
+        float previousDistance = planeDistance(plane, *previous);
+        for (int32_t i = 0; i < count; i++)
+        {
+            const ClipVertex *current = &input[i];
+            float distance = planeDistance(plane, *current);
+
+            // the intersection is always computed from the inside vertex so a shared edge
+            // is split at the same point by both of its triangles
+            if ((previousDistance >= 0) != (distance >= 0))
+            {
+                if (previousDistance >= 0)
+                    output[outputCount++] = lerp(*previous, *current, previousDistance / (previousDistance - distance));
+                else
+                    output[outputCount++] = lerp(*current, *previous, distance / (distance - previousDistance));
+            }
+            if (distance >= 0)
+                output[outputCount++] = *current;
+
+            previous = current;
+            previousDistance = distance;
+        }
+
+        ClipVertex *swap = input;
+        input = output;
+        output = swap;
+        count = outputCount;
+    }
+
+    if (input != polygon.vertices)
+    {
+        for (int32_t i = 0; i < count; i++)
+        {
+            polygon.vertices[i] = input[i];
+        }
+    }
+    polygon.count = count;
+}
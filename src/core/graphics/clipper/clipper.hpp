@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+
+// After the projection x and y are inside [-w, w] and z inside [0, w] for anything on screen
+// between the near and far plane
+typedef struct
+{
+    float x, y, z, w;
+} ClipVertex;
+
+#define CLIP_PLANE_LEFT (1u << 0)
+#define CLIP_PLANE_RIGHT (1u << 1)
+#define CLIP_PLANE_TOP (1u << 2)
+#define CLIP_PLANE_BOTTOM (1u << 3)
+#define CLIP_PLANE_NEAR (1u << 4)
+#define CLIP_PLANE_FAR (1u << 5)
+
+// The rasterizer scissors to the screen, x and y only have to be clipped where the projected
+// vertices would leave the fixed point range. These planes sit CLIP_GUARD_BAND screens out.
+#define CLIP_GUARD_BAND 64.f
+#define CLIP_PLANE_GUARD_LEFT (1u << 6)
+#define CLIP_PLANE_GUARD_RIGHT (1u << 7)
+#define CLIP_PLANE_GUARD_TOP (1u << 8)
+#define CLIP_PLANE_GUARD_BOTTOM (1u << 9)
+#define CLIP_PLANE_COUNT 10
+
+#define CLIP_PLANES_SCREEN (CLIP_PLANE_LEFT | CLIP_PLANE_RIGHT | CLIP_PLANE_TOP | CLIP_PLANE_BOTTOM)
+#define CLIP_PLANES_DEPTH (CLIP_PLANE_NEAR | CLIP_PLANE_FAR)
+#define CLIP_PLANES_GUARD_BAND (CLIP_PLANE_GUARD_LEFT | CLIP_PLANE_GUARD_RIGHT | CLIP_PLANE_GUARD_TOP | CLIP_PLANE_GUARD_BOTTOM)
+
+// every plane can add one vertex to the triangle
+#define CLIP_MAX_VERTICES (3 + CLIP_PLANE_COUNT)
+
+// convex polygon, triangle i of its fan is vertices 0, i + 1, i + 2
+typedef struct
+{
+    ClipVertex vertices[CLIP_MAX_VERTICES];
+    int32_t count;
+} ClipPolygon;
+
+namespace Clipper
+{
+    // bit i is set if the vertex is outside plane i
+    uint32_t outcode(const ClipVertex &vertex);
+
+    // Sutherland-Hodgman against the planes in the mask, in place. The polygon ends up empty,
+    // count < 3, if it is completely outside.
+    void clipPolygon(ClipPolygon &polygon, uint32_t planes);
+}
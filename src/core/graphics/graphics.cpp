@@ -22,7 +22,7 @@ void Graphics::initImGUI()
     ImGui_ImplOpenGL3_Init(glsl_version);
 }
 
-Graphics::Graphics(int32_t width, int32_t height) : imageData({width, height})
+Graphics::Graphics(int32_t width, int32_t height) : imageData({width, height}), renderer(imageData), spanBuffer(imageData)
 {
 
     glfwInit();
@@ -107,6 +107,7 @@ void Graphics::newFrame(void)
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
     imageData.clearZBuffer();
+    frameArena.reset();
 }
 
 void Graphics::endFrame(void)
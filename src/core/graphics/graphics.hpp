@@ -1,6 +1,9 @@
 #pragma once
 #include "imageData/imagedata.hpp"
+#include "rasterizer/tileRenderer.hpp"
+#include "rasterizer/spanBuffer.hpp"
 #include "../shader/shader.hpp"
+#include "../frameArena/frameArena.hpp"
 #include <memory>
 #include <cstdint>
 #include <glad/glad.h>
@@ -10,6 +13,10 @@ class Graphics
 {
 public:
     ImageData imageData;
+    TileRenderer renderer;
+    SpanBuffer spanBuffer;
+    // transient buffers of the frame being drawn, reset by newFrame()
+    FrameArena frameArena;
 
     Graphics(int32_t width, int32_t height);
     ~Graphics();
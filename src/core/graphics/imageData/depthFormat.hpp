@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+
+#define DEPTH_FORMAT_FLOAT32 0
+#define DEPTH_FORMAT_FIXED24 1
+#define DEPTH_FORMAT_FIXED16 2
+
+// the zBuffer format is picked at build time, e.g. -DDEPTH_FORMAT=DEPTH_FORMAT_FIXED16
+#ifndef DEPTH_FORMAT
+#define DEPTH_FORMAT DEPTH_FORMAT_FLOAT32
+#endif
+
+// Depth is reverse-Z: near / z is 1 on the near plane of the camera and goes to 0 at infinity,
+// so nearer is bigger and the buffer clears to 0. The rasterizer interpolates it as a float and
+// each format encodes it on store. The clamps are written the way maxps/minps behave so the
+// scalar and SIMD kernels encode to the same bits.
+
+template <int Format>
+struct DepthFormat;
+
+template <>
+struct DepthFormat<DEPTH_FORMAT_FLOAT32>
+{
+    typedef float Type;
+    static constexpr Type clearValue = 0;
+
+    static inline Type encode(float depth)
+    {
+        return depth;
+    }
+
+    static inline float decode(Type value)
+    {
+        return value;
+    }
+};
+
+// 24 bits of fixed point in a 32 bit word, leaves room for a stencil
+template <>
+struct DepthFormat<DEPTH_FORMAT_FIXED24>
+{
+    typedef uint32_t Type;
+    static constexpr Type clearValue = 0;
+    static constexpr float scale = 0xFFFFFF;
+
+    static inline Type encode(float depth)
+    {
+        depth = depth > 0.f ? depth : 0.f;
+        depth = depth < 1.f ? depth : 1.f;
+        return (Type)(depth * scale);
+    }
+
+    static inline float decode(Type value)
+    {
+        return value / scale;
+    }
+};
+
+template <>
+struct DepthFormat<DEPTH_FORMAT_FIXED16>
+{
+    typedef uint16_t Type;
+    static constexpr Type clearValue = 0;
+    static constexpr float scale = 0xFFFF;
+
+    static inline Type encode(float depth)
+    {
+        depth = depth > 0.f ? depth : 0.f;
+        depth = depth < 1.f ? depth : 1.f;
+        return (Type)(depth * scale);
+    }
+
+    static inline float decode(Type value)
+    {
+        return value / scale;
+    }
+};
+
+typedef DepthFormat<DEPTH_FORMAT> ZBufferFormat;
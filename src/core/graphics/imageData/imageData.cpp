@@ -1,5 +1,6 @@
 #include "imagedata.hpp"
-#include "../../math/mathUtils.hpp"
+#include "../rasterizer/spanKernel.hpp"
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <array>
@@ -36,8 +37,12 @@ bool ImageData::putPixelZbuffer(PointI point, ZBufferT color)
           point.x < size.x &&
           point.y < size.y))
         return false;
+    int tile = point.x / ZBUFFER_TILE_SIZE + point.y / ZBUFFER_TILE_SIZE * tileCount.x;
+    prepareZBufferTile(tile);
+
     int position = (point.x + point.y * this->size.x);
     this->zBuffer[position] = color;
+    tileFarZ[tile] = std::min(tileFarZ[tile], color);
     return true;
 }
 
@@ -53,7 +58,12 @@ ZBufferT ImageData::getPixelZBuffer(PointI point)
           point.y > 0 &&
           point.x < size.x &&
           point.y < size.y))
-        return 0;
+        return ZBufferFormat::clearValue;
+
+    int tile = point.x / ZBUFFER_TILE_SIZE + point.y / ZBUFFER_TILE_SIZE * tileCount.x;
+    if (tileEpoch[tile] != zBufferEpoch)
+        return ZBufferFormat::clearValue;
+
     int position = point.x + point.y * this->size.x;
     return this->zBuffer[position];
 }
@@ -101,7 +111,32 @@ void ImageData::clear(void)
 
 void ImageData::clearZBuffer(void)
 {
-    std::fill(zBuffer.begin(), zBuffer.end(), ZBUFFER_MAX);
+    zBufferEpoch++;
+
+    // an old tile could alias the new epoch after wrapping around, clear everything for real
+    if (zBufferEpoch == 0)
+    {
+        std::fill(zBuffer.begin(), zBuffer.end(), ZBufferFormat::clearValue);
+        std::fill(idBuffer.begin(), idBuffer.end(), VISIBILITY_NONE);
+        std::fill(tileFarZ.begin(), tileFarZ.end(), ZBufferFormat::clearValue);
+        std::fill(tileEpoch.begin(), tileEpoch.end(), zBufferEpoch);
+    }
+}
+
+void ImageData::clearZBufferTile(int32_t tile)
+{
+    int32_t x0 = tile % tileCount.x * ZBUFFER_TILE_SIZE;
+    int32_t y0 = tile / tileCount.x * ZBUFFER_TILE_SIZE;
+    int32_t width = std::min(x0 + ZBUFFER_TILE_SIZE, size.x) - x0;
+    int32_t y1 = std::min(y0 + ZBUFFER_TILE_SIZE, size.y);
+
+    for (int32_t y = y0; y < y1; y++)
+    {
+        std::fill_n(zBuffer.begin() + x0 + y * size.x, width, ZBufferFormat::clearValue);
+        std::fill_n(idBuffer.begin() + x0 + y * size.x, width, VISIBILITY_NONE);
+    }
+    tileFarZ[tile] = ZBufferFormat::clearValue;
+    tileEpoch[tile] = zBufferEpoch;
 }
 
 void ImageData::clearTransparent(void)
@@ -153,56 +188,52 @@ void ImageData::printString(PointI topLeftCorner, const std::string &string, con
     }
 }
 
-ZBufferT getZForTriangle(PointI position, std::array<PointI, 3> triangle)
+DepthPlane getDepthPlane(const std::array<PointF, 3> &triangle, float nearPlane)
 {
-    PointI planeNormalI = (triangle[0] - triangle[1]).cross(triangle[0] - triangle[2]);
-    PointF planeNormalF = {(float)planeNormalI.x, (float)planeNormalI.y, (float)planeNormalI.z};
-    PointF planePoint = {(float)triangle[0].x, (float)triangle[0].y, (float)triangle[0].z};
-    auto point = MathUtils::intersectionPoint({0, 0, 1}, {(float)position.x, (float)position.y, 0}, planeNormalF, planePoint);
-    return -1.f / point.z;
-}
+    float z0 = nearPlane / triangle[0].z;
+    float z1 = nearPlane / triangle[1].z;
+    float z2 = nearPlane / triangle[2].z;
 
-void ImageData::drawLineZ(PointI pointA, PointI pointB, std::array<PointI, 3> triangle, Color color)
-{
+    float x1 = triangle[1].x - triangle[0].x;
+    float y1 = triangle[1].y - triangle[0].y;
+    float x2 = triangle[2].x - triangle[0].x;
+    float y2 = triangle[2].y - triangle[0].y;
+    float area = x1 * y2 - x2 * y1;
 
-    int dx = abs(pointB.x - pointA.x);
-    int sx = pointA.x < pointB.x ? 1 : -1;
-    int sy = -1;
-    int err = dx > 0 ? dx / 2 : 0;
-    int e2 = 0;
+    float min = std::min({z0, z1, z2});
+    float max = std::max({z0, z1, z2});
 
-    while (true)
-    {
-        auto z = getZForTriangle(pointA, triangle);
+    if (area == 0)
+        return {z0, 0, 0, min, max};
 
-        auto zBufferValue = getPixelZBuffer(pointA);
-        if (z < zBufferValue)
-        {
-            putPixelZbuffer(pointA, z);
-            // if (zBufferValue != ZBUFFER_MAX)
-            // {
-            // this->putPixel(pointA, {0xFF, 0, 0});
-            // }
-            // else
-            // {
-            this->putPixel(pointA, color);
-            // }
-        }
+    float dzdx = ((z1 - z0) * y2 - (z2 - z0) * y1) / area;
+    float dzdy = ((z2 - z0) * x1 - (z1 - z0) * x2) / area;
 
-        if (pointA.x == pointB.x)
-            break;
+    // pixel x covers [x, x + 1), fold the half pixel in so the plane is sampled at its centre
+    float originX = triangle[0].x - 0.5f;
+    float originY = triangle[0].y - 0.5f;
+    return {z0 - dzdx * originX - dzdy * originY, dzdx, dzdy, min, max};
+}
 
-        e2 = err;
-        if (e2 > -dx)
-        {
-            pointA.x += sx;
-        }
-        if (e2 < 0)
-        {
-            err += dx;
-            pointA.y += sy;
-        }
+void ImageData::drawLineZ(PointI pointA, PointI pointB, const DepthPlane &depth, Color color)
+{
+    if (pointA.y < 0 || pointA.y >= size.y)
+        return;
+
+    int32_t start = std::max(std::min(pointA.x, pointB.x), 0);
+    int32_t end = std::min(std::max(pointA.x, pointB.x), size.x - 1);
+    if (start > end)
+        return;
+
+    int32_t tileRow = pointA.y / ZBUFFER_TILE_SIZE * tileCount.x;
+    for (int32_t tile = start / ZBUFFER_TILE_SIZE; tile <= end / ZBUFFER_TILE_SIZE; tile++)
+    {
+        prepareZBufferTile(tileRow + tile);
     }
+
+    int32_t position = start + pointA.y * size.x;
+    float z = depth.z + depth.dzdx * start + depth.dzdy * pointA.y;
+    SpanKernel::drawSpan(&data[position], &zBuffer[position], end - start + 1, z, SpanKernel::makeSpanSetup(depth.dzdx, color));
 }
 
 void ImageData::drawLine(PointI pointA, PointI pointB, Color color)
@@ -245,21 +276,19 @@ void ImageData::drawSquareFill(PointI topLeftCorner, PointI size, Color color)
 
 void ImageData::drawZBuffer(PointI position)
 {
-    for (int i = 0; i < size.x; i++)
+    for (int32_t tile = 0; tile < tileCount.x * tileCount.y; tile++)
     {
-        for (int j = 0; j < size.y; j++)
-        {
-
-            // ZBufferT pixel = getPixelZBuffer({i, j});
-            // Color *c1 = (Color *)&pixel;
-            auto z = getPixelZBuffer({i, j});
-            // auto normalizedZ = z != ZBUFFER_MAX ? ZBUFFER_MAX - z / ZBUFFER_MAX * 230 : 0;
-            auto normalizedZ = z * 30000.f;
-            auto pixel = (unsigned char)(normalizedZ);
-            // auto pixel = MathUtils::map<uint64_t>(getPixelZBuffer({i, j}), 0, 255, 0, UINT64_MAX);
-            // auto pixel = static_cast<unsigned char>(MathUtils::map<ZBufferT>(getPixelZBuffer({i, j}), 255, ZBUFFER_MAX));
+        prepareZBufferTile(tile);
+    }
 
-            this->putPixel({i, j}, (Color){pixel, pixel, pixel});
+    for (int j = 0; j < size.y; j++)
+    {
+        for (int i = 0; i < size.x; i++)
+        {
+            // reverse-Z decodes to 1 on the near plane, so near is white and the sky black
+            int index = i + j * size.x;
+            auto pixel = static_cast<unsigned char>(ZBufferFormat::decode(zBuffer[index]) * 255);
+            data[index] = {pixel, pixel, pixel};
         }
     }
 }
@@ -277,6 +306,11 @@ void ImageData::createTexture(void)
 
     data = std::vector<Color>(size.x * size.y, initialColor);
     zBuffer = std::vector<ZBufferT>(size.x * size.y, 0);
+    idBuffer = std::vector<uint32_t>(size.x * size.y, VISIBILITY_NONE);
+
+    tileCount = {(size.x + ZBUFFER_TILE_SIZE - 1) / ZBUFFER_TILE_SIZE, (size.y + ZBUFFER_TILE_SIZE - 1) / ZBUFFER_TILE_SIZE};
+    tileFarZ = std::vector<ZBufferT>(tileCount.x * tileCount.y, 0);
+    tileEpoch = std::vector<uint32_t>(tileCount.x * tileCount.y, zBufferEpoch);
 
     glTexImage2D(GL_TEXTURE_2D,
                  0,
@@ -7,6 +7,7 @@
 #include <array>
 #include <float.h>
 #include "../../math/vector/vector3.hpp"
+#include "depthFormat.hpp"
 
 typedef struct
 {
@@ -29,8 +30,19 @@ typedef union
     float a[4];
 } Mat4Elem;
 
-typedef double ZBufferT;
-#define ZBUFFER_MAX 100000.f
+typedef ZBufferFormat::Type ZBufferT;
+#define ZBUFFER_TILE_SIZE 8
+
+// idBuffer value of a pixel no triangle has been drawn to
+#define VISIBILITY_NONE 0
+
+// 1/z is linear in screen space, so the depth of a triangle at the centre of pixel (x, y) is
+// z + dzdx * x + dzdy * y. min and max are the depth range of the vertices.
+typedef struct
+{
+    float z, dzdx, dzdy;
+    float min, max;
+} DepthPlane;
 
 class ImageData
 {
@@ -52,21 +64,44 @@ public:
     void printFontTest(void);
     void printString(PointI topLeftCorner, const std::string &string, const Color color = {0xFF, 0xFF, 0xFF});
     void drawLine(PointI pointA, PointI pointB, Color color = {0xFF, 0xFF, 0xFF});
-    void drawLineZ(PointI pointA, PointI pointB, std::array<PointI, 3> triangle, Color color);
+    void drawLineZ(PointI pointA, PointI pointB, const DepthPlane &depth, Color color);
     void drawSquareFill(PointI topLeftCorner, PointI size, Color color = {0xFF, 0xFF, 0xFF});
     void drawZBuffer(PointI position);
     Color getPixel(PointU position);
     bool putPixelZbuffer(PointI point, ZBufferT color);
     ZBufferT getPixelZBuffer(PointI position);
 
+    // clearZBuffer() only starts a new epoch, a tile is cleared the first time it is touched after
+    // that. Anything reading or writing zBuffer, idBuffer or tileFarZ directly has to prepare the
+    // tile first.
+    inline void prepareZBufferTile(int32_t tile)
+    {
+        if (tileEpoch[tile] != zBufferEpoch)
+            clearZBufferTile(tile);
+    }
+
     PointI size;
     int bufferSize;
     int elementCount;
 
     std::vector<Color> data;
     std::vector<ZBufferT> zBuffer;
+    // triangle drawn to each pixel in visibility buffer mode, cleared along with the zBuffer
+    std::vector<uint32_t> idBuffer;
+
+    // farthest depth stored in each ZBUFFER_TILE_SIZE square tile of the zBuffer
+    PointI tileCount;
+    std::vector<ZBufferT> tileFarZ;
+
+    // view depth stored as 1, set each frame from the camera the triangles are projected with
+    float nearPlane = 1.f;
 
 private:
     uint32_t textureId;
+    uint32_t zBufferEpoch = 0;
+    std::vector<uint32_t> tileEpoch;
     void createTexture(void);
-};
\ No newline at end of file
+    void clearZBufferTile(int32_t tile);
+};
+
+DepthPlane getDepthPlane(const std::array<PointF, 3> &triangle, float nearPlane);
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "rasterizer.hpp"
+#include <algorithm>
+#include <cmath>
+
+static EdgeFunction makeEdge(PointI a, PointI b)
+{
+    int64_t dy = (int64_t)a.y - b.y;
+    int64_t dx = (int64_t)b.x - a.x;
+    int64_t c = (int64_t)a.x * b.y - (int64_t)a.y * b.x;
+
+    // the inside is towards (dy, dx), so a left edge has dy > 0 and a top edge has dy == 0, dx > 0
+    bool topLeft = dy > 0 || (dy == 0 && dx > 0);
+    if (!topLeft)
+        c -= 1;
+
+    // step whole pixels and sample at their centres
+    return {dy * RASTER_SUBPIXEL_STEPS,
+            dx * RASTER_SUBPIXEL_STEPS,
+            c + (dy + dx) * (RASTER_SUBPIXEL_STEPS / 2)};
+}
+
+static inline int32_t snapToSubpixel(float value)
+{
+    return (int32_t)lrintf(value * RASTER_SUBPIXEL_STEPS);
+}
+
+// first and last pixel whose centre is in [min, max], min and max in 28.4
+static inline int32_t firstPixel(int32_t min)
+{
+    return (min - RASTER_SUBPIXEL_STEPS / 2 + RASTER_SUBPIXEL_STEPS - 1) >> RASTER_SUBPIXEL_BITS;
+}
+
+static inline int32_t lastPixel(int32_t max)
+{
+    return (max - RASTER_SUBPIXEL_STEPS / 2) >> RASTER_SUBPIXEL_BITS;
+}
+
+static inline int64_t evaluateEdge(const EdgeFunction &edge, int32_t x, int32_t y)
+{
+    return edge.a * x + edge.b * y + edge.c;
+}
+
+bool Rasterizer::setupTriangle(TriangleSetup &setup, const Triangle<float> &triangle, PointI screenSize, float nearPlane)
+{
+    std::array<PointF, 3> points = triangle.vertices;
+    auto &vertices = setup.vertices;
+    for (int i = 0; i < 3; i++)
+    {
+        if (!(std::abs(points[i].x) <= RASTER_MAX_COORDINATE && std::abs(points[i].y) <= RASTER_MAX_COORDINATE))
+            return false;
+
+        vertices[i] = {snapToSubpixel(points[i].x), snapToSubpixel(points[i].y), 0};
+        // the depth plane goes through the snapped positions too
+        points[i].x = (float)vertices[i].x / RASTER_SUBPIXEL_STEPS;
+        points[i].y = (float)vertices[i].y / RASTER_SUBPIXEL_STEPS;
+    }
+    setup.color = triangle.color;
+
+    int64_t area = (int64_t)(vertices[1].x - vertices[0].x) * (vertices[2].y - vertices[0].y) -
+                   (int64_t)(vertices[2].x - vertices[0].x) * (vertices[1].y - vertices[0].y);
+    if (area == 0)
+        return false;
+
+    // both windings are drawn, the edges are built so the inside is always positive
+    if (area < 0)
+    {
+        std::swap(vertices[1], vertices[2]);
+        std::swap(points[1], points[2]);
+    }
+
+    setup.edges[0] = makeEdge(vertices[1], vertices[2]);
+    setup.edges[1] = makeEdge(vertices[2], vertices[0]);
+    setup.edges[2] = makeEdge(vertices[0], vertices[1]);
+    setup.depth = getDepthPlane(points, nearPlane);
+    setup.span = SpanKernel::makeSpanSetup(setup.depth.dzdx, setup.color);
+
+    setup.min.x = std::max(firstPixel(std::min({vertices[0].x, vertices[1].x, vertices[2].x})), 0);
+    setup.min.y = std::max(firstPixel(std::min({vertices[0].y, vertices[1].y, vertices[2].y})), 0);
+    setup.max.x = std::min(lastPixel(std::max({vertices[0].x, vertices[1].x, vertices[2].x})), screenSize.x - 1);
+    setup.max.y = std::min(lastPixel(std::max({vertices[0].y, vertices[1].y, vertices[2].y})), screenSize.y - 1);
+
+    return setup.min.x <= setup.max.x && setup.min.y <= setup.max.y;
+}
+
+void Rasterizer::rasterizeTile(ImageData &imageData, const TriangleSetup &setup, PointI tile)
+{
+    int32_t x0 = std::max(tile.x * RASTER_TILE_SIZE, setup.min.x);
+    int32_t y0 = std::max(tile.y * RASTER_TILE_SIZE, setup.min.y);
+    int32_t x1 = std::min(tile.x * RASTER_TILE_SIZE + RASTER_TILE_SIZE - 1, setup.max.x);
+    int32_t y1 = std::min(tile.y * RASTER_TILE_SIZE + RASTER_TILE_SIZE - 1, setup.max.y);
+
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    // depth range of the triangle over the tile, the plane is linear so it is also on the corners
+    const DepthPlane &depth = setup.depth;
+    float cornerZ = depth.z + depth.dzdx * x0 + depth.dzdy * y0;
+    float spanX = depth.dzdx * (x1 - x0);
+    float spanY = depth.dzdy * (y1 - y0);
+    float nearZ = std::min(cornerZ + std::max(spanX, 0.f) + std::max(spanY, 0.f), depth.max);
+    float farZ = std::max(cornerZ + std::min(spanX, 0.f) + std::min(spanY, 0.f), depth.min);
+
+    int32_t tileIndex = tile.x + tile.y * imageData.tileCount.x;
+    imageData.prepareZBufferTile(tileIndex);
+    if (ZBufferFormat::encode(nearZ) <= imageData.tileFarZ[tileIndex])
+        return;
+
+    // the edge functions are linear, so their extremes over the tile are on its corners
+    bool fullyCovered = true;
+    std::array<int64_t, 3> rowValues;
+    for (int i = 0; i < 3; i++)
+    {
+        const EdgeFunction &edge = setup.edges[i];
+        int64_t value = evaluateEdge(edge, x0, y0);
+        int64_t maxValue = value + std::max<int64_t>(edge.a, 0) * (x1 - x0) + std::max<int64_t>(edge.b, 0) * (y1 - y0);
+        int64_t minValue = value + std::min<int64_t>(edge.a, 0) * (x1 - x0) + std::min<int64_t>(edge.b, 0) * (y1 - y0);
+
+        if (maxValue < 0)
+            return;
+
+        if (minValue < 0)
+            fullyCovered = false;
+
+        rowValues[i] = value;
+    }
+
+    // spans always start on the tile column so lane i is column i of the tile, the SIMD
+    // kernels read all 8 columns and can't be used on a tile hanging off the right edge
+    int32_t tileX = tile.x * RASTER_TILE_SIZE;
+    bool inside = tileX + RASTER_TILE_SIZE <= imageData.size.x;
+    SpanFunction drawSpan8 = inside ? SpanKernel::drawSpan8 : SpanKernel::drawSpan8Scalar;
+    IdSpanFunction drawIdSpan8 = inside ? SpanKernel::drawIdSpan8 : SpanKernel::drawIdSpan8Scalar;
+    // triangles with an id go to the visibility buffer instead of the colour buffer
+    bool writeIds = setup.span.id != VISIBILITY_NONE;
+    uint32_t columns = ((1u << (x1 - x0 + 1)) - 1) << (x0 - tileX);
+
+    float rowZ = depth.z + depth.dzdx * tileX + depth.dzdy * y0;
+
+    for (int32_t y = y0; y <= y1; y++)
+    {
+        uint32_t coverage = columns;
+        if (!fullyCovered)
+        {
+            coverage = 0;
+            int64_t e0 = rowValues[0];
+            int64_t e1 = rowValues[1];
+            int64_t e2 = rowValues[2];
+            for (int32_t x = x0 - tileX; x <= x1 - tileX; x++)
+            {
+                if ((e0 | e1 | e2) >= 0)
+                    coverage |= 1u << x;
+
+                e0 += setup.edges[0].a;
+                e1 += setup.edges[1].a;
+                e2 += setup.edges[2].a;
+            }
+            rowValues[0] += setup.edges[0].b;
+            rowValues[1] += setup.edges[1].b;
+            rowValues[2] += setup.edges[2].b;
+        }
+
+        if (coverage)
+        {
+            int32_t position = tileX + y * imageData.size.x;
+            if (writeIds)
+                drawIdSpan8(&imageData.idBuffer[position], &imageData.zBuffer[position], rowZ, coverage, setup.span);
+            else
+                drawSpan8(&imageData.data[position], &imageData.zBuffer[position], rowZ, coverage, setup.span);
+        }
+        rowZ += depth.dzdy;
+    }
+
+    // every pixel of the tile now holds max(old, triangle) >= farZ
+    int32_t tileY = tile.y * RASTER_TILE_SIZE;
+    bool wholeTile = fullyCovered &&
+                     x0 == tileX && x1 == std::min(tileX + RASTER_TILE_SIZE, imageData.size.x) - 1 &&
+                     y0 == tileY && y1 == std::min(tileY + RASTER_TILE_SIZE, imageData.size.y) - 1;
+    if (wholeTile)
+        imageData.tileFarZ[tileIndex] = std::max(imageData.tileFarZ[tileIndex], ZBufferFormat::encode(farZ));
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "../imageData/imagedata.hpp"
+#include "../../math/mathUtils.hpp"
+#include "spanKernel.hpp"
+
+// bins line up with the coarse depth tiles of ImageData
+#define RASTER_TILE_SIZE ZBUFFER_TILE_SIZE
+
+// vertices are snapped to 28.4 fixed point
+#define RASTER_SUBPIXEL_BITS 4
+#define RASTER_SUBPIXEL_STEPS (1 << RASTER_SUBPIXEL_BITS)
+
+// screen coordinates past this many pixels would overflow the edge functions
+#define RASTER_MAX_COORDINATE (1 << 20)
+
+// E(x, y) = a * x + b * y + c at the centre of pixel (x, y), inside the triangle when
+// E >= 0. Edges that are not top or left are biased by one so shared edges are only drawn once.
+typedef struct
+{
+    int64_t a, b, c;
+} EdgeFunction;
+
+typedef struct
+{
+    std::array<EdgeFunction, 3> edges;
+    std::array<PointI, 3> vertices; // 28.4 fixed point
+    DepthPlane depth;
+    SpanSetup span;
+    PointI min;
+    PointI max;
+    Color color;
+} TriangleSetup;
+
+namespace Rasterizer
+{
+    bool setupTriangle(TriangleSetup &setup, const Triangle<float> &triangle, PointI screenSize, float nearPlane);
+    void rasterizeTile(ImageData &imageData, const TriangleSetup &setup, PointI tile);
+}
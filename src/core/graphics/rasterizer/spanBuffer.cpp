@@ -0,0 +1,132 @@
+#include "spanBuffer.hpp"
+#include <algorithm>
+
+static inline int64_t floorDiv(int64_t numerator, int64_t denominator)
+{
+    return numerator >= 0 ? numerator / denominator : -((denominator - 1 - numerator) / denominator);
+}
+
+SpanBuffer::SpanBuffer(ImageData &pImageData) : imageData(pImageData)
+{
+    rows.resize(imageData.size.y);
+}
+
+void SpanBuffer::submit(const Triangle<float> &triangle)
+{
+    TriangleSetup setup;
+    if (!Rasterizer::setupTriangle(setup, triangle, imageData.size, imageData.nearPlane))
+        return;
+
+    uint32_t index = triangles.size();
+    triangles.push_back({setup.depth, setup.color});
+
+    // same edge functions as the tiled rasterizer, solved for the covered range of each row
+    for (int32_t y = setup.min.y; y <= setup.max.y; y++)
+    {
+        int64_t x0 = setup.min.x;
+        int64_t x1 = setup.max.x + 1;
+        for (const EdgeFunction &edge : setup.edges)
+        {
+            int64_t rowValue = edge.b * y + edge.c;
+            if (edge.a > 0)
+                x0 = std::max(x0, -floorDiv(rowValue, edge.a));
+            else if (edge.a < 0)
+                x1 = std::min(x1, floorDiv(rowValue, -edge.a) + 1);
+            else if (rowValue < 0)
+                x1 = x0;
+        }
+
+        if (x0 < x1)
+            insertSpan(y, {(int32_t)x0, (int32_t)x1, index});
+    }
+}
+
+void SpanBuffer::flush(void)
+{
+    for (size_t y = 0; y < rows.size(); y++)
+    {
+        Color *row = &imageData.data[y * imageData.size.x];
+        for (const ScreenSpan &span : rows[y])
+        {
+            std::fill(row + span.x0, row + span.x1, triangles[span.triangle].color);
+        }
+        rows[y].clear();
+    }
+    triangles.clear();
+}
+
+float SpanBuffer::depthAt(uint32_t triangle, int32_t x, int32_t y)
+{
+    const DepthPlane &depth = triangles[triangle].depth;
+    return depth.z + depth.dzdx * x + depth.dzdy * y;
+}
+
+void SpanBuffer::emit(const ScreenSpan &span, int32_t x0, int32_t x1)
+{
+    if (x0 >= x1)
+        return;
+
+    if (!scratch.empty() && scratch.back().triangle == span.triangle && scratch.back().x1 == x0)
+        scratch.back().x1 = x1;
+    else
+        scratch.push_back({x0, x1, span.triangle});
+}
+
+void SpanBuffer::insertSpan(int32_t y, const ScreenSpan &span)
+{
+    auto newWins = [this, &span, y](const ScreenSpan &old, int32_t x) -> bool
+    { return depthAt(span.triangle, x, y) > depthAt(old.triangle, x, y); };
+
+    // merge into scratch left to right, cur is where the unresolved part of span starts
+    scratch.clear();
+    int32_t cur = span.x0;
+    for (const ScreenSpan &old : rows[y])
+    {
+        if (cur < old.x0)
+        {
+            int32_t end = std::min(old.x0, span.x1);
+            emit(span, cur, end);
+            cur = std::max(cur, end);
+        }
+
+        int32_t overlapStart = std::max(old.x0, cur);
+        int32_t overlapEnd = std::min(old.x1, span.x1);
+        if (overlapStart >= overlapEnd)
+        {
+            emit(old, old.x0, old.x1);
+            continue;
+        }
+
+        emit(old, old.x0, overlapStart);
+
+        // both depths are linear in x, so the nearer one changes at most once over the overlap
+        bool firstWins = newWins(old, overlapStart);
+        bool lastWins = newWins(old, overlapEnd - 1);
+        if (firstWins == lastWins)
+        {
+            emit(firstWins ? span : old, overlapStart, overlapEnd);
+        }
+        else
+        {
+            int32_t low = overlapStart + 1;
+            int32_t high = overlapEnd - 1;
+            while (low < high)
+            {
+                int32_t middle = (low + high) / 2;
+                if (newWins(old, middle) == lastWins)
+                    high = middle;
+                else
+                    low = middle + 1;
+            }
+            emit(firstWins ? span : old, overlapStart, low);
+            emit(lastWins ? span : old, low, overlapEnd);
+        }
+
+        emit(old, overlapEnd, old.x1);
+        cur = overlapEnd;
+    }
+    emit(span, cur, span.x1);
+
+    // copied rather than swapped, every row keeps its own capacity and stops allocating
+    rows[y].assign(scratch.begin(), scratch.end());
+}
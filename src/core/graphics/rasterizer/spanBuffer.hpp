@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "rasterizer.hpp"
+
+// pixels [x0, x1) of a scanline are covered by triangle
+typedef struct
+{
+    int32_t x0, x1;
+    uint32_t triangle;
+} ScreenSpan;
+
+typedef struct
+{
+    DepthPlane depth;
+    Color color;
+} SpanSource;
+
+// S-buffer: every scanline keeps a sorted list of visible, non overlapping spans. Submitted
+// triangles are cut into spans and resolved against that list, flush() then writes each
+// covered pixel once. The zBuffer is neither read nor written.
+class SpanBuffer
+{
+public:
+    ImageData &imageData;
+
+    SpanBuffer(ImageData &imageData);
+
+    void submit(const Triangle<float> &triangle);
+    void flush(void);
+
+private:
+    std::vector<SpanSource> triangles;
+    std::vector<std::vector<ScreenSpan>> rows;
+    std::vector<ScreenSpan> scratch;
+
+    void insertSpan(int32_t y, const ScreenSpan &span);
+    void emit(const ScreenSpan &span, int32_t x0, int32_t x1);
+    float depthAt(uint32_t triangle, int32_t x, int32_t y);
+};
@@ -0,0 +1,315 @@
+#include "spanKernel.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SPAN_KERNEL_X86
+#endif
+
+SpanSetup SpanKernel::makeSpanSetup(float dzdx, Color color)
+{
+    SpanSetup span;
+    for (int i = 0; i < SPAN_KERNEL_WIDTH; i++)
+    {
+        span.laneOffsets[i] = dzdx * i;
+        span.colorPattern[i * 3 + 0] = color.r;
+        span.colorPattern[i * 3 + 1] = color.g;
+        span.colorPattern[i * 3 + 2] = color.b;
+    }
+    span.chunkStep = dzdx * SPAN_KERNEL_WIDTH;
+    span.color = color;
+    span.id = VISIBILITY_NONE;
+    return span;
+}
+
+void SpanKernel::drawSpan(Color *colors, ZBufferT *depths, int32_t count, float z, const SpanSetup &span)
+{
+    for (; count >= SPAN_KERNEL_WIDTH; count -= SPAN_KERNEL_WIDTH)
+    {
+        drawSpan8(colors, depths, z, 0xFF, span);
+        colors += SPAN_KERNEL_WIDTH;
+        depths += SPAN_KERNEL_WIDTH;
+        z += span.chunkStep;
+    }
+
+    // the tail would read past the end of the row
+    if (count > 0)
+        drawSpan8Scalar(colors, depths, z, (1u << count) - 1, span);
+}
+
+template <int Format>
+static void drawSpan8ScalarFormat(Color *colors, typename DepthFormat<Format>::Type *depths, float z, uint32_t coverage, const SpanSetup &span)
+{
+    for (int i = 0; i < SPAN_KERNEL_WIDTH; i++)
+    {
+        if (!(coverage & (1u << i)))
+            continue;
+
+        auto laneZ = DepthFormat<Format>::encode(z + span.laneOffsets[i]);
+        if (laneZ > depths[i])
+        {
+            depths[i] = laneZ;
+            colors[i] = span.color;
+        }
+    }
+}
+
+void SpanKernel::drawSpan8Scalar(Color *colors, ZBufferT *depths, float z, uint32_t coverage, const SpanSetup &span)
+{
+    drawSpan8ScalarFormat<DEPTH_FORMAT>(colors, depths, z, coverage, span);
+}
+
+template <int Format>
+static void drawIdSpan8ScalarFormat(uint32_t *ids, typename DepthFormat<Format>::Type *depths, float z, uint32_t coverage, const SpanSetup &span)
+{
+    for (int i = 0; i < SPAN_KERNEL_WIDTH; i++)
+    {
+        if (!(coverage & (1u << i)))
+            continue;
+
+        auto laneZ = DepthFormat<Format>::encode(z + span.laneOffsets[i]);
+        if (laneZ > depths[i])
+        {
+            depths[i] = laneZ;
+            ids[i] = span.id;
+        }
+    }
+}
+
+void SpanKernel::drawIdSpan8Scalar(uint32_t *ids, ZBufferT *depths, float z, uint32_t coverage, const SpanSetup &span)
+{
+    drawIdSpan8ScalarFormat<DEPTH_FORMAT>(ids, depths, z, coverage, span);
+}
+
+#ifdef SPAN_KERNEL_X86
+
+// Colour is 3 bytes per pixel, so 8 pixels are blended as 16 + 8 bytes. Byte i of the
+// 24 belongs to pixel i / 3, these select the coverage bit for every byte.
+static inline void storeColors8(Color *colors, uint32_t mask, const SpanSetup &span)
+{
+    const __m128i selectLow = _mm_setr_epi8(1, 1, 1, 2, 2, 2, 4, 4, 4, 8, 8, 8, 16, 16, 16, 32);
+    const __m128i selectHigh = _mm_setr_epi8(32, 32, 64, 64, 64, -128, -128, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    __m128i maskBytes = _mm_set1_epi8((char)mask);
+    __m128i blendLow = _mm_cmpeq_epi8(_mm_and_si128(maskBytes, selectLow), selectLow);
+    __m128i blendHigh = _mm_cmpeq_epi8(_mm_and_si128(maskBytes, selectHigh), selectHigh);
+
+    __m128i colorLow = _mm_loadu_si128((const __m128i *)span.colorPattern);
+    __m128i colorHigh = _mm_loadl_epi64((const __m128i *)(span.colorPattern + 16));
+
+    unsigned char *bytes = (unsigned char *)colors;
+    __m128i oldLow = _mm_loadu_si128((const __m128i *)bytes);
+    __m128i oldHigh = _mm_loadl_epi64((const __m128i *)(bytes + 16));
+
+    _mm_storeu_si128((__m128i *)bytes, _mm_or_si128(_mm_and_si128(blendLow, colorLow), _mm_andnot_si128(blendLow, oldLow)));
+    _mm_storel_epi64((__m128i *)(bytes + 16), _mm_or_si128(_mm_and_si128(blendHigh, colorHigh), _mm_andnot_si128(blendHigh, oldHigh)));
+}
+
+static inline __m128i blendSSE2(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline void coverageLanesSSE2(uint32_t coverage, __m128i &low, __m128i &high)
+{
+    const __m128i bitsLow = _mm_setr_epi32(1, 2, 4, 8);
+    const __m128i bitsHigh = _mm_setr_epi32(16, 32, 64, 128);
+
+    __m128i coverageVector = _mm_set1_epi32(coverage);
+    low = _mm_cmpeq_epi32(_mm_and_si128(coverageVector, bitsLow), bitsLow);
+    high = _mm_cmpeq_epi32(_mm_and_si128(coverageVector, bitsHigh), bitsHigh);
+}
+
+// clamp to [0, 1] and scale, the same operations as DepthFormat::encode
+static inline __m128i encodeFixedSSE2(__m128 z, float scale)
+{
+    z = _mm_min_ps(_mm_max_ps(z, _mm_setzero_ps()), _mm_set1_ps(1.f));
+    return _mm_cvttps_epi32(_mm_mul_ps(z, _mm_set1_ps(scale)));
+}
+
+// The depth tests store the passing lanes and return them as a bit mask
+
+template <int Format>
+static inline uint32_t depthTest8SSE2(typename DepthFormat<Format>::Type *depths, __m128 zLow, __m128 zHigh, uint32_t coverage);
+
+template <>
+inline uint32_t depthTest8SSE2<DEPTH_FORMAT_FLOAT32>(float *depths, __m128 zLow, __m128 zHigh, uint32_t coverage)
+{
+    __m128i coveredLow, coveredHigh;
+    coverageLanesSSE2(coverage, coveredLow, coveredHigh);
+
+    __m128 oldLow = _mm_loadu_ps(depths);
+    __m128 oldHigh = _mm_loadu_ps(depths + 4);
+    __m128 passLow = _mm_and_ps(_mm_cmpgt_ps(zLow, oldLow), _mm_castsi128_ps(coveredLow));
+    __m128 passHigh = _mm_and_ps(_mm_cmpgt_ps(zHigh, oldHigh), _mm_castsi128_ps(coveredHigh));
+
+    _mm_storeu_ps(depths, _mm_or_ps(_mm_and_ps(passLow, zLow), _mm_andnot_ps(passLow, oldLow)));
+    _mm_storeu_ps(depths + 4, _mm_or_ps(_mm_and_ps(passHigh, zHigh), _mm_andnot_ps(passHigh, oldHigh)));
+
+    return _mm_movemask_ps(passLow) | (_mm_movemask_ps(passHigh) << 4);
+}
+
+// 24 bit values fit in the signed 32 bit compare
+template <>
+inline uint32_t depthTest8SSE2<DEPTH_FORMAT_FIXED24>(uint32_t *depths, __m128 zLow, __m128 zHigh, uint32_t coverage)
+{
+    __m128i coveredLow, coveredHigh;
+    coverageLanesSSE2(coverage, coveredLow, coveredHigh);
+
+    __m128i newLow = encodeFixedSSE2(zLow, DepthFormat<DEPTH_FORMAT_FIXED24>::scale);
+    __m128i newHigh = encodeFixedSSE2(zHigh, DepthFormat<DEPTH_FORMAT_FIXED24>::scale);
+    __m128i oldLow = _mm_loadu_si128((const __m128i *)depths);
+    __m128i oldHigh = _mm_loadu_si128((const __m128i *)(depths + 4));
+    __m128i passLow = _mm_and_si128(_mm_cmpgt_epi32(newLow, oldLow), coveredLow);
+    __m128i passHigh = _mm_and_si128(_mm_cmpgt_epi32(newHigh, oldHigh), coveredHigh);
+
+    _mm_storeu_si128((__m128i *)depths, blendSSE2(passLow, newLow, oldLow));
+    _mm_storeu_si128((__m128i *)(depths + 4), blendSSE2(passHigh, newHigh, oldHigh));
+
+    return _mm_movemask_ps(_mm_castsi128_ps(passLow)) | (_mm_movemask_ps(_mm_castsi128_ps(passHigh)) << 4);
+}
+
+// SSE2 only has signed 16 bit compares, values are biased by 0x8000 to keep their order
+static inline uint32_t depthTest8Fixed16(uint16_t *depths, __m128i newLow, __m128i newHigh, uint32_t coverage)
+{
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16(-0x8000);
+    const __m128i bits = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+
+    __m128i covered = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(coverage), bits), bits);
+    __m128i newBiased = _mm_packs_epi32(_mm_sub_epi32(newLow, bias32), _mm_sub_epi32(newHigh, bias32));
+    __m128i old = _mm_loadu_si128((const __m128i *)depths);
+    __m128i pass = _mm_and_si128(_mm_cmpgt_epi16(newBiased, _mm_xor_si128(old, bias16)), covered);
+
+    _mm_storeu_si128((__m128i *)depths, blendSSE2(pass, _mm_xor_si128(newBiased, bias16), old));
+
+    return _mm_movemask_epi8(_mm_packs_epi16(pass, _mm_setzero_si128())) & 0xFF;
+}
+
+template <>
+inline uint32_t depthTest8SSE2<DEPTH_FORMAT_FIXED16>(uint16_t *depths, __m128 zLow, __m128 zHigh, uint32_t coverage)
+{
+    __m128i newLow = encodeFixedSSE2(zLow, DepthFormat<DEPTH_FORMAT_FIXED16>::scale);
+    __m128i newHigh = encodeFixedSSE2(zHigh, DepthFormat<DEPTH_FORMAT_FIXED16>::scale);
+    return depthTest8Fixed16(depths, newLow, newHigh, coverage);
+}
+
+template <int Format>
+static void drawSpan8SSE2(Color *colors, typename DepthFormat<Format>::Type *depths, float z, uint32_t coverage, const SpanSetup &span)
+{
+    __m128 start = _mm_set1_ps(z);
+    __m128 zLow = _mm_add_ps(start, _mm_loadu_ps(span.laneOffsets));
+    __m128 zHigh = _mm_add_ps(start, _mm_loadu_ps(span.laneOffsets + 4));
+
+    uint32_t passed = depthTest8SSE2<Format>(depths, zLow, zHigh, coverage);
+    if (passed)
+        storeColors8(colors, passed, span);
+}
+
+template <int Format>
+static void drawIdSpan8SSE2(uint32_t *ids, typename DepthFormat<Format>::Type *depths, float z, uint32_t coverage, const SpanSetup &span)
+{
+    __m128 start = _mm_set1_ps(z);
+    __m128 zLow = _mm_add_ps(start, _mm_loadu_ps(span.laneOffsets));
+    __m128 zHigh = _mm_add_ps(start, _mm_loadu_ps(span.laneOffsets + 4));
+
+    uint32_t passed = depthTest8SSE2<Format>(depths, zLow, zHigh, coverage);
+    if (!passed)
+        return;
+
+    __m128i passLow, passHigh;
+    coverageLanesSSE2(passed, passLow, passHigh);
+    __m128i id = _mm_set1_epi32(span.id);
+    _mm_storeu_si128((__m128i *)ids, blendSSE2(passLow, id, _mm_loadu_si128((const __m128i *)ids)));
+    _mm_storeu_si128((__m128i *)(ids + 4), blendSSE2(passHigh, id, _mm_loadu_si128((const __m128i *)(ids + 4))));
+}
+
+__attribute__((target("avx2"))) static inline __m256 coverageLanesAVX2(uint32_t coverage)
+{
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256i coverageVector = _mm256_set1_epi32(coverage);
+    return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(coverageVector, bits), bits));
+}
+
+__attribute__((target("avx2"))) static inline __m256i encodeFixedAVX2(__m256 z, float scale)
+{
+    z = _mm256_min_ps(_mm256_max_ps(z, _mm256_setzero_ps()), _mm256_set1_ps(1.f));
+    return _mm256_cvttps_epi32(_mm256_mul_ps(z, _mm256_set1_ps(scale)));
+}
+
+template <int Format>
+static inline uint32_t depthTest8AVX2(typename DepthFormat<Format>::Type *depths, __m256 z, uint32_t coverage);
+
+template <>
+__attribute__((target("avx2"))) inline uint32_t depthTest8AVX2<DEPTH_FORMAT_FLOAT32>(float *depths, __m256 z, uint32_t coverage)
+{
+    __m256 pass = _mm256_and_ps(_mm256_cmp_ps(z, _mm256_loadu_ps(depths), _CMP_GT_OQ), coverageLanesAVX2(coverage));
+    _mm256_maskstore_ps(depths, _mm256_castps_si256(pass), z);
+    return _mm256_movemask_ps(pass);
+}
+
+template <>
+__attribute__((target("avx2"))) inline uint32_t depthTest8AVX2<DEPTH_FORMAT_FIXED24>(uint32_t *depths, __m256 z, uint32_t coverage)
+{
+    __m256i newDepth = encodeFixedAVX2(z, DepthFormat<DEPTH_FORMAT_FIXED24>::scale);
+    __m256i old = _mm256_loadu_si256((const __m256i *)depths);
+    __m256i pass = _mm256_and_si256(_mm256_cmpgt_epi32(newDepth, old), _mm256_castps_si256(coverageLanesAVX2(coverage)));
+    _mm256_maskstore_epi32((int *)depths, pass, newDepth);
+    return _mm256_movemask_ps(_mm256_castsi256_ps(pass));
+}
+
+// there is no 16 bit masked store, the pack and blend are done on 128 bits
+template <>
+__attribute__((target("avx2"))) inline uint32_t depthTest8AVX2<DEPTH_FORMAT_FIXED16>(uint16_t *depths, __m256 z, uint32_t coverage)
+{
+    __m256i newDepth = encodeFixedAVX2(z, DepthFormat<DEPTH_FORMAT_FIXED16>::scale);
+    return depthTest8Fixed16(depths, _mm256_castsi256_si128(newDepth), _mm256_extracti128_si256(newDepth, 1), coverage);
+}
+
+template <int Format>
+__attribute__((target("avx2"))) static void drawSpan8AVX2(Color *colors, typename DepthFormat<Format>::Type *depths, float z, uint32_t coverage, const SpanSetup &span)
+{
+    __m256 laneZ = _mm256_add_ps(_mm256_set1_ps(z), _mm256_loadu_ps(span.laneOffsets));
+
+    uint32_t passed = depthTest8AVX2<Format>(depths, laneZ, coverage);
+    if (passed)
+        storeColors8(colors, passed, span);
+}
+
+template <int Format>
+__attribute__((target("avx2"))) static void drawIdSpan8AVX2(uint32_t *ids, typename DepthFormat<Format>::Type *depths, float z, uint32_t coverage, const SpanSetup &span)
+{
+    __m256 laneZ = _mm256_add_ps(_mm256_set1_ps(z), _mm256_loadu_ps(span.laneOffsets));
+
+    uint32_t passed = depthTest8AVX2<Format>(depths, laneZ, coverage);
+    if (passed)
+        _mm256_maskstore_epi32((int *)ids, _mm256_castps_si256(coverageLanesAVX2(passed)), _mm256_set1_epi32(span.id));
+}
+
+#endif
+
+SpanFunction SpanKernel::selectSpanFunction(void)
+{
+#ifdef SPAN_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return drawSpan8AVX2<DEPTH_FORMAT>;
+    return drawSpan8SSE2<DEPTH_FORMAT>;
+#else
+    return drawSpan8Scalar;
+#endif
+}
+
+IdSpanFunction SpanKernel::selectIdSpanFunction(void)
+{
+#ifdef SPAN_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return drawIdSpan8AVX2<DEPTH_FORMAT>;
+    return drawIdSpan8SSE2<DEPTH_FORMAT>;
+#else
+    return drawIdSpan8Scalar;
+#endif
+}
+
+SpanFunction SpanKernel::drawSpan8 = SpanKernel::selectSpanFunction();
+IdSpanFunction SpanKernel::drawIdSpan8 = SpanKernel::selectIdSpanFunction();
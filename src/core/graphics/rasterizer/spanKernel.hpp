@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include "../imageData/imagedata.hpp"
+
+#define SPAN_KERNEL_WIDTH 8
+
+// Per triangle constants of the span kernels. Lane i of a chunk gets z + laneOffsets[i], the
+// scalar and SIMD kernels do exactly the same operations so their results are bit identical.
+typedef struct
+{
+    float laneOffsets[SPAN_KERNEL_WIDTH];
+    float chunkStep;
+    Color color;
+    uint32_t id;
+    unsigned char colorPattern[SPAN_KERNEL_WIDTH * sizeof(Color)];
+} SpanSetup;
+
+// Depth tests and writes 8 consecutive pixels, pixel i is only written if bit i of coverage is
+// set. The SIMD kernels read all 8 pixels, so they must all be inside the buffer.
+typedef void (*SpanFunction)(Color *colors, ZBufferT *depths, float z, uint32_t coverage, const SpanSetup &span);
+
+// same depth test, the passing pixels get span.id instead of a colour
+typedef void (*IdSpanFunction)(uint32_t *ids, ZBufferT *depths, float z, uint32_t coverage, const SpanSetup &span);
+
+namespace SpanKernel
+{
+    SpanSetup makeSpanSetup(float dzdx, Color color);
+    void drawSpan(Color *colors, ZBufferT *depths, int32_t count, float z, const SpanSetup &span);
+    SpanFunction selectSpanFunction(void);
+    IdSpanFunction selectIdSpanFunction(void);
+
+    void drawSpan8Scalar(Color *colors, ZBufferT *depths, float z, uint32_t coverage, const SpanSetup &span);
+    void drawIdSpan8Scalar(uint32_t *ids, ZBufferT *depths, float z, uint32_t coverage, const SpanSetup &span);
+
+    // the best kernels the CPU supports for ZBufferFormat, picked at startup
+    extern SpanFunction drawSpan8;
+    extern IdSpanFunction drawIdSpan8;
+}
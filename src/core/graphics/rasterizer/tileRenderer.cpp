@@ -0,0 +1,181 @@
+#include "tileRenderer.hpp"
+#include <algorithm>
+
+TileRenderer::TileRenderer(ImageData &pImageData, int32_t threadCount) : imageData(pImageData)
+{
+    tileCount.x = (imageData.size.x + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    tileCount.y = (imageData.size.y + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    bins.resize(tileCount.x * tileCount.y);
+
+    // the thread calling flush() rasterizes too
+    for (int32_t i = 1; i < threadCount; i++)
+    {
+        workers.emplace_back(&TileRenderer::workerLoop, this);
+    }
+}
+
+TileRenderer::~TileRenderer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void TileRenderer::submit(const Triangle<float> &triangle)
+{
+    TriangleSetup setup;
+    if (!Rasterizer::setupTriangle(setup, triangle, imageData.size, imageData.nearPlane))
+        return;
+
+    binTriangle(setup);
+}
+
+void TileRenderer::submit(const std::array<PointF, 3> &vertices, const Surface &surface)
+{
+    if (!visibilityBuffer)
+    {
+        submit({vertices, Shading::flat(surface)});
+        return;
+    }
+
+    TriangleSetup setup;
+    if (!Rasterizer::setupTriangle(setup, {vertices, surface.diffuse}, imageData.size, imageData.nearPlane))
+        return;
+
+    // ids start at 1, VISIBILITY_NONE is 0
+    surfaces.emplace_back(surface);
+    setup.span.id = surfaces.size();
+    binTriangle(setup);
+}
+
+void TileRenderer::binTriangle(const TriangleSetup &setup)
+{
+    uint32_t index = triangles.size();
+    triangles.emplace_back(setup);
+
+    for (int32_t tileY = setup.min.y / RASTER_TILE_SIZE; tileY <= setup.max.y / RASTER_TILE_SIZE; tileY++)
+    {
+        for (int32_t tileX = setup.min.x / RASTER_TILE_SIZE; tileX <= setup.max.x / RASTER_TILE_SIZE; tileX++)
+        {
+            bins[tileX + tileY * tileCount.x].emplace_back(index);
+        }
+    }
+}
+
+void TileRenderer::flush(void)
+{
+    if (multiThreaded && !workers.empty())
+    {
+        nextBin = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pendingWorkers = workers.size();
+            generation++;
+        }
+        workReady.notify_all();
+
+        rasterizeBins();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        workDone.wait(lock, [this]
+                      { return pendingWorkers == 0; });
+    }
+    else
+    {
+        for (size_t bin = 0; bin < bins.size(); bin++)
+        {
+            rasterizeBin(bin);
+        }
+    }
+
+    // clear() keeps the capacity, so steady state binning does not allocate
+    triangles.clear();
+    surfaces.clear();
+    for (auto &bin : bins)
+    {
+        bin.clear();
+    }
+}
+
+void TileRenderer::workerLoop(void)
+{
+    uint64_t lastGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [this, lastGeneration]
+                           { return stopping || generation != lastGeneration; });
+            if (stopping)
+                return;
+            lastGeneration = generation;
+        }
+
+        rasterizeBins();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pendingWorkers == 0)
+            workDone.notify_one();
+    }
+}
+
+void TileRenderer::rasterizeBins(void)
+{
+    int32_t binCount = bins.size();
+    for (int32_t bin = nextBin++; bin < binCount; bin = nextBin++)
+    {
+        rasterizeBin(bin);
+    }
+}
+
+void TileRenderer::rasterizeBin(int32_t bin)
+{
+    PointI tile = {bin % tileCount.x, bin / tileCount.x};
+    for (auto index : bins[bin])
+    {
+        Rasterizer::rasterizeTile(imageData, triangles[index], tile);
+    }
+
+    // a tile with triangles binned to it has been prepared this frame, so its ids are current
+    if (!surfaces.empty() && !bins[bin].empty())
+        resolveTile(tile);
+}
+
+void TileRenderer::resolveTile(PointI tile)
+{
+    int32_t x0 = tile.x * RASTER_TILE_SIZE;
+    int32_t y0 = tile.y * RASTER_TILE_SIZE;
+    int32_t x1 = std::min(x0 + RASTER_TILE_SIZE, imageData.size.x);
+    int32_t y1 = std::min(y0 + RASTER_TILE_SIZE, imageData.size.y);
+
+    uint32_t lastId = VISIBILITY_NONE;
+    Color color;
+    for (int32_t y = y0; y < y1; y++)
+    {
+        for (int32_t x = x0; x < x1; x++)
+        {
+            int32_t position = x + y * imageData.size.x;
+            uint32_t id = imageData.idBuffer[position];
+            if (id == VISIBILITY_NONE)
+                continue;
+
+            // flat shading is constant over a triangle, neighbours with the same id reuse it
+            if (id != lastId)
+            {
+                color = Shading::flat(surfaces[id - 1]);
+                lastId = id;
+            }
+            imageData.data[position] = color;
+
+            // the ids are only valid until flush() returns, a later flush must not shade this pixel again
+            imageData.idBuffer[position] = VISIBILITY_NONE;
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "rasterizer.hpp"
+#include "../shading/shading.hpp"
+
+// Sort-middle renderer: triangles are set up and binned into screen tiles as they are
+// submitted, flush() rasterizes every tile on the worker pool. A tile is only ever touched
+// by one thread and replays its bin in submission order, so no locks are needed on the
+// buffers and the result matches the single threaded path bit for bit.
+//
+// With visibilityBuffer set, surfaces are not shaded on submit. Their triangles only write an
+// id and depth, and each tile is shaded once its bin is done, one shade per visible pixel.
+class TileRenderer
+{
+public:
+    ImageData &imageData;
+    bool multiThreaded = true;
+    bool visibilityBuffer = false;
+
+    TileRenderer(ImageData &imageData, int32_t threadCount = std::thread::hardware_concurrency());
+    ~TileRenderer();
+
+    void submit(const Triangle<float> &triangle);
+    void submit(const std::array<PointF, 3> &vertices, const Surface &surface);
+    void flush(void);
+
+private:
+    PointI tileCount;
+    std::vector<TriangleSetup> triangles;
+    std::vector<Surface> surfaces;
+    std::vector<std::vector<uint32_t>> bins;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    std::atomic<int32_t> nextBin;
+    int32_t pendingWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void workerLoop(void);
+    void rasterizeBins(void);
+    void rasterizeBin(int32_t bin);
+    void binTriangle(const TriangleSetup &setup);
+    void resolveTile(PointI tile);
+};
@@ -0,0 +1,14 @@
+#include <cmath>
+#include "shading.hpp"
+
+namespace Shading
+{
+    Color flat(const Surface &surface)
+    {
+        PointF normal = surface.normal;
+        auto component = normal.angleWith({1, 1, 1}) / M_PI;
+        return {static_cast<unsigned char>(surface.diffuse.r * component),
+                static_cast<unsigned char>(surface.diffuse.g * component),
+                static_cast<unsigned char>(surface.diffuse.b * component)};
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "../imageData/imagedata.hpp"
+
+// what a triangle needs to be shaded, kept until a pixel of it is known to be visible
+typedef struct
+{
+    PointF normal;
+    Color diffuse;
+} Surface;
+
+namespace Shading
+{
+    Color flat(const Surface &surface);
+}
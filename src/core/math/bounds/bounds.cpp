@@ -0,0 +1,210 @@
+#include "bounds.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BOUNDS_X86
+#endif
+
+static inline float planeDistance(const PointF &plane, const PointF &point)
+{
+    return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+}
+
+namespace Bounds
+{
+    BoundingBox boxFromPoints(const VertexStream &points)
+    {
+        if (points.size() == 0)
+            return {{0}, {0}};
+
+        BoundingBox box = {points[0], points[0]};
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            PointF point = points[i];
+            box.min = {std::min(box.min.x, point.x), std::min(box.min.y, point.y), std::min(box.min.z, point.z), 1.f};
+            box.max = {std::max(box.max.x, point.x), std::max(box.max.y, point.y), std::max(box.max.z, point.z), 1.f};
+        }
+        return box;
+    }
+
+    // centred on the box, not the tightest sphere but close enough for boxy meshes
+    BoundingSphere sphereFromPoints(const VertexStream &points, const BoundingBox &box)
+    {
+        PointF center = {(box.min.x + box.max.x) / 2, (box.min.y + box.max.y) / 2, (box.min.z + box.max.z) / 2, 1.f};
+        float radiusSquared = 0;
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            PointF point = points[i];
+            PointF offset = {point.x - center.x, point.y - center.y, point.z - center.z};
+            radiusSquared = std::max(radiusSquared, offset.dot(offset));
+        }
+        return {center, sqrtf(radiusSquared)};
+    }
+
+    BoundingBox transformBox(const BoundingBox &box, PointF matrix[4])
+    {
+        BoundingBox result;
+        for (int i = 0; i < 8; i++)
+        {
+            PointF corner = {i & 1 ? box.max.x : box.min.x,
+                             i & 2 ? box.max.y : box.min.y,
+                             i & 4 ? box.max.z : box.min.z,
+                             1.f};
+            PointF transformed;
+            MathUtils::multiplyVertexByMatrix(transformed, corner, matrix);
+            if (i == 0)
+                result = {transformed, transformed};
+
+            result.min = {std::min(result.min.x, transformed.x), std::min(result.min.y, transformed.y), std::min(result.min.z, transformed.z), 1.f};
+            result.max = {std::max(result.max.x, transformed.x), std::max(result.max.y, transformed.y), std::max(result.max.z, transformed.z), 1.f};
+        }
+        return result;
+    }
+
+    BoundingSphere transformSphere(const BoundingSphere &sphere, PointF matrix[4])
+    {
+        PointF center = sphere.center;
+        PointF transformedCenter;
+        MathUtils::multiplyVertexByMatrix(transformedCenter, center, matrix);
+
+        // Object3D matrices are rotation * scale * translation with row vectors, so column j of
+        // the upper 3x3 has length s_j and the longest column is the largest stretch
+        float scale = 0;
+        PointF columns[3] = {{matrix[0].x, matrix[1].x, matrix[2].x},
+                             {matrix[0].y, matrix[1].y, matrix[2].y},
+                             {matrix[0].z, matrix[1].z, matrix[2].z}};
+        for (auto &column : columns)
+        {
+            scale = std::max(scale, column.dot(column));
+        }
+        return {transformedCenter, sphere.radius * sqrtf(scale)};
+    }
+
+    BoundingBox merge(const BoundingBox &a, const BoundingBox &b)
+    {
+        return {{std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z), 1.f},
+                {std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z), 1.f}};
+    }
+
+    bool overlaps(const BoundingBox &a, const BoundingBox &b)
+    {
+        return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+               a.min.y <= b.max.y && b.min.y <= a.max.y &&
+               a.min.z <= b.max.z && b.min.z <= a.max.z;
+    }
+
+    bool intersectRay(const BoundingBox &box, PointF origin, PointF inverseDirection, float maxDistance, float &distance)
+    {
+        float enter = 0;
+        float leave = maxDistance;
+        const float origins[3] = {origin.x, origin.y, origin.z};
+        const float inverse[3] = {inverseDirection.x, inverseDirection.y, inverseDirection.z};
+        const float mins[3] = {box.min.x, box.min.y, box.min.z};
+        const float maxs[3] = {box.max.x, box.max.y, box.max.z};
+        for (int i = 0; i < 3; i++)
+        {
+            float t0 = (mins[i] - origins[i]) * inverse[i];
+            float t1 = (maxs[i] - origins[i]) * inverse[i];
+            // a ray along a slab boundary gives nan, std::max and std::min keep the other value then
+            enter = std::max(enter, std::min(t0, t1));
+            leave = std::min(leave, std::max(t0, t1));
+        }
+        distance = enter;
+        return enter <= leave;
+    }
+
+    int32_t classifyBox(const Frustum &frustum, const BoundingBox &box, uint32_t &planeMask)
+    {
+        for (int i = 0; i < FRUSTUM_PLANE_COUNT; i++)
+        {
+            if (!(planeMask & (1u << i)))
+                continue;
+
+            const PointF &plane = frustum.planes[i];
+            PointF positive = {plane.x >= 0 ? box.max.x : box.min.x, plane.y >= 0 ? box.max.y : box.min.y, plane.z >= 0 ? box.max.z : box.min.z};
+            PointF negative = {plane.x >= 0 ? box.min.x : box.max.x, plane.y >= 0 ? box.min.y : box.max.y, plane.z >= 0 ? box.min.z : box.max.z};
+            if (planeDistance(plane, positive) < 0)
+                return CULL_OUTSIDE;
+            if (planeDistance(plane, negative) >= 0)
+                planeMask &= ~(1u << i);
+        }
+        return planeMask ? CULL_INTERSECTING : CULL_INSIDE;
+    }
+
+    int32_t classify(const Frustum &frustum, const BoundingSphere &sphere, const BoundingBox &box)
+    {
+        int32_t result = CULL_INSIDE;
+        for (auto &plane : frustum.planes)
+        {
+            float distance = planeDistance(plane, sphere.center);
+            if (distance >= sphere.radius)
+                continue;
+            if (distance < -sphere.radius)
+                return CULL_OUTSIDE;
+
+            // the corners furthest along and against the plane normal
+            PointF positive = {plane.x >= 0 ? box.max.x : box.min.x, plane.y >= 0 ? box.max.y : box.min.y, plane.z >= 0 ? box.max.z : box.min.z};
+            PointF negative = {plane.x >= 0 ? box.min.x : box.max.x, plane.y >= 0 ? box.min.y : box.max.y, plane.z >= 0 ? box.min.z : box.max.z};
+            if (planeDistance(plane, positive) < 0)
+                return CULL_OUTSIDE;
+            if (planeDistance(plane, negative) < 0)
+                result = CULL_INTERSECTING;
+        }
+        return result;
+    }
+
+    void classifySpheres(const Frustum &frustum, const float *x, const float *y, const float *z, const float *radius,
+                         size_t blockCount, uint8_t *results)
+    {
+        size_t count = blockCount * VERTEX_STREAM_WIDTH;
+#ifdef BOUNDS_X86
+        // four spheres against one plane per step, SSE2 is always there on x86
+        for (size_t i = 0; i < count; i += 4)
+        {
+            __m128 centerX = _mm_load_ps(x + i);
+            __m128 centerY = _mm_load_ps(y + i);
+            __m128 centerZ = _mm_load_ps(z + i);
+            __m128 sphereRadius = _mm_load_ps(radius + i);
+            __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), sphereRadius);
+            __m128 outside = _mm_setzero_ps();
+            __m128 intersecting = _mm_setzero_ps();
+            for (auto &plane : frustum.planes)
+            {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), centerX), _mm_mul_ps(_mm_set1_ps(plane.y), centerY));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.z), centerZ));
+                distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+                intersecting = _mm_or_ps(intersecting, _mm_cmplt_ps(distance, sphereRadius));
+            }
+
+            int outsideMask = _mm_movemask_ps(outside);
+            int intersectingMask = _mm_movemask_ps(intersecting);
+            for (int lane = 0; lane < 4; lane++)
+            {
+                results[i + lane] = (outsideMask >> lane) & 1        ? CULL_OUTSIDE
+                                    : (intersectingMask >> lane) & 1 ? CULL_INTERSECTING
+                                                                     : CULL_INSIDE;
+            }
+        }
+#else
+        for (size_t i = 0; i < count; i++)
+        {
+            PointF center = {x[i], y[i], z[i], 1.f};
+            results[i] = CULL_INSIDE;
+            for (auto &plane : frustum.planes)
+            {
+                float distance = planeDistance(plane, center);
+                if (distance < -radius[i])
+                {
+                    results[i] = CULL_OUTSIDE;
+                    break;
+                }
+                if (distance < radius[i])
+                    results[i] = CULL_INTERSECTING;
+            }
+        }
+#endif
+    }
+}
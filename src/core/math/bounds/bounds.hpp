@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "../mathUtils.hpp"
+#include "../vertexStream/vertexStream.hpp"
+
+typedef struct
+{
+    PointF min, max;
+} BoundingBox;
+
+typedef struct
+{
+    PointF center;
+    float radius;
+} BoundingSphere;
+
+// planes are (normal, distance) in x, y, z and w, a point is inside when dot(normal, p) + w >= 0
+#define FRUSTUM_PLANE_COUNT 6
+typedef struct
+{
+    PointF planes[FRUSTUM_PLANE_COUNT];
+} Frustum;
+
+#define CULL_OUTSIDE 0
+#define CULL_INTERSECTING 1
+#define CULL_INSIDE 2
+
+// one bit per frustum plane, the planes a volume still has to be tested against
+#define FRUSTUM_PLANES_ALL ((1u << FRUSTUM_PLANE_COUNT) - 1)
+
+namespace Bounds
+{
+    BoundingBox boxFromPoints(const VertexStream &points);
+    BoundingSphere sphereFromPoints(const VertexStream &points, const BoundingBox &box);
+
+    // bounds of the volume after multiplying by matrix
+    BoundingBox transformBox(const BoundingBox &box, PointF matrix[4]);
+    BoundingSphere transformSphere(const BoundingSphere &sphere, PointF matrix[4]);
+    BoundingBox merge(const BoundingBox &a, const BoundingBox &b);
+    bool overlaps(const BoundingBox &a, const BoundingBox &b);
+    // slab test, inverseDirection is 1 / direction per axis, distance is where the ray enters
+    bool intersectRay(const BoundingBox &box, PointF origin, PointF inverseDirection, float maxDistance, float &distance);
+
+    // the sphere is tested first, the box only for the planes the sphere straddles
+    int32_t classify(const Frustum &frustum, const BoundingSphere &sphere, const BoundingBox &box);
+    // Box only, against the planes in planeMask. The planes the box straddles are left in the
+    // mask, everything inside the box only has to be tested against those.
+    int32_t classifyBox(const Frustum &frustum, const BoundingBox &box, uint32_t &planeMask);
+
+    // Spheres only, blockCount * VERTEX_STREAM_WIDTH of them at once. The centres and radii are
+    // aligned and padded streams, results gets one CULL_* value per sphere.
+    void classifySpheres(const Frustum &frustum, const float *x, const float *y, const float *z, const float *radius,
+                         size_t blockCount, uint8_t *results);
+}
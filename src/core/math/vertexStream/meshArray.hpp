@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Array of mesh data that either owns its elements or reads them in place from a mapped mesh
+// file. Elements can only be added, a mapped array is copied into its own storage first.
+template <typename T>
+class MeshArray
+{
+public:
+    void push_back(const T &value)
+    {
+        own();
+        storage.push_back(value);
+    }
+
+    template <typename... Args>
+    void emplace_back(Args &&...args)
+    {
+        own();
+        storage.emplace_back(std::forward<Args>(args)...);
+    }
+
+    void map(const T *data, size_t count)
+    {
+        storage.clear();
+        mapped = data;
+        mappedCount = count;
+    }
+
+    const T &operator[](size_t index) const { return data()[index]; }
+    const T *data(void) const { return mapped ? mapped : storage.data(); }
+    size_t size(void) const { return mapped ? mappedCount : storage.size(); }
+    bool empty(void) const { return size() == 0; }
+    const T *begin(void) const { return data(); }
+    const T *end(void) const { return data() + size(); }
+
+private:
+    std::vector<T> storage;
+    const T *mapped = nullptr;
+    size_t mappedCount = 0;
+
+    void own(void)
+    {
+        if (!mapped)
+            return;
+
+        storage.assign(mapped, mapped + mappedCount);
+        mapped = nullptr;
+    }
+};
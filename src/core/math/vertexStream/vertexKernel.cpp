@@ -0,0 +1,90 @@
+#include "vertexKernel.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VERTEX_KERNEL_X86
+#endif
+
+void VertexKernel::transformScalar(const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ, float *outW, size_t blockCount, PointF matrix[4])
+{
+    size_t count = blockCount * VERTEX_STREAM_WIDTH;
+    for (size_t i = 0; i < count; i++)
+    {
+        outX[i] = x[i] * matrix[0].x + y[i] * matrix[1].x + z[i] * matrix[2].x + matrix[3].x;
+        outY[i] = x[i] * matrix[0].y + y[i] * matrix[1].y + z[i] * matrix[2].y + matrix[3].y;
+        outZ[i] = x[i] * matrix[0].z + y[i] * matrix[1].z + z[i] * matrix[2].z + matrix[3].z;
+        outW[i] = x[i] * matrix[0].w + y[i] * matrix[1].w + z[i] * matrix[2].w + matrix[3].w;
+    }
+}
+
+#ifdef VERTEX_KERNEL_X86
+
+static void transformSSE2(const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ, float *outW, size_t blockCount, PointF matrix[4])
+{
+    __m128 m[4][4];
+    for (int row = 0; row < 4; row++)
+    {
+        m[row][0] = _mm_set1_ps(matrix[row].x);
+        m[row][1] = _mm_set1_ps(matrix[row].y);
+        m[row][2] = _mm_set1_ps(matrix[row].z);
+        m[row][3] = _mm_set1_ps(matrix[row].w);
+    }
+
+    float *outputs[4] = {outX, outY, outZ, outW};
+    size_t count = blockCount * VERTEX_STREAM_WIDTH;
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 vx = _mm_load_ps(x + i);
+        __m128 vy = _mm_load_ps(y + i);
+        __m128 vz = _mm_load_ps(z + i);
+        for (int axis = 0; axis < 4; axis++)
+        {
+            __m128 result = _mm_add_ps(_mm_mul_ps(vx, m[0][axis]), _mm_mul_ps(vy, m[1][axis]));
+            result = _mm_add_ps(result, _mm_mul_ps(vz, m[2][axis]));
+            _mm_store_ps(outputs[axis] + i, _mm_add_ps(result, m[3][axis]));
+        }
+    }
+}
+
+__attribute__((target("avx"))) static void transformAVX(const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ, float *outW, size_t blockCount, PointF matrix[4])
+{
+    __m256 m[4][4];
+    for (int row = 0; row < 4; row++)
+    {
+        m[row][0] = _mm256_set1_ps(matrix[row].x);
+        m[row][1] = _mm256_set1_ps(matrix[row].y);
+        m[row][2] = _mm256_set1_ps(matrix[row].z);
+        m[row][3] = _mm256_set1_ps(matrix[row].w);
+    }
+
+    float *outputs[4] = {outX, outY, outZ, outW};
+    size_t count = blockCount * VERTEX_STREAM_WIDTH;
+    for (size_t i = 0; i < count; i += VERTEX_STREAM_WIDTH)
+    {
+        __m256 vx = _mm256_load_ps(x + i);
+        __m256 vy = _mm256_load_ps(y + i);
+        __m256 vz = _mm256_load_ps(z + i);
+        for (int axis = 0; axis < 4; axis++)
+        {
+            __m256 result = _mm256_add_ps(_mm256_mul_ps(vx, m[0][axis]), _mm256_mul_ps(vy, m[1][axis]));
+            result = _mm256_add_ps(result, _mm256_mul_ps(vz, m[2][axis]));
+            _mm256_store_ps(outputs[axis] + i, _mm256_add_ps(result, m[3][axis]));
+        }
+    }
+}
+
+#endif
+
+TransformFunction VertexKernel::selectTransformFunction(void)
+{
+#ifdef VERTEX_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx"))
+        return transformAVX;
+    return transformSSE2;
+#else
+    return transformScalar;
+#endif
+}
+
+TransformFunction VertexKernel::transform = VertexKernel::selectTransformFunction();
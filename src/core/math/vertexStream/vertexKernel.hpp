@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include "vertexStream.hpp"
+
+// Transforms blockCount * VERTEX_STREAM_WIDTH points (x, y, z, 1) by a row vector matrix and
+// writes the results as x, y, z and w streams. Every pointer is VERTEX_STREAM_ALIGNMENT aligned.
+typedef void (*TransformFunction)(const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ, float *outW, size_t blockCount, PointF matrix[4]);
+
+namespace VertexKernel
+{
+    // the additions happen in the same order as in MathUtils::multiplyVertexByMatrix, so all
+    // kernels are bit identical to it
+    void transformScalar(const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ, float *outW, size_t blockCount, PointF matrix[4]);
+    TransformFunction selectTransformFunction(void);
+
+    // the best kernel the CPU supports, picked at startup
+    extern TransformFunction transform;
+}
@@ -0,0 +1,61 @@
+#include "vertexStream.hpp"
+
+void VertexStream::push_back(PointF point)
+{
+    own();
+    size_t lane = count % VERTEX_STREAM_WIDTH;
+    if (lane == 0)
+    {
+        x.push_back({0});
+        y.push_back({0});
+        z.push_back({0});
+    }
+
+    x.back().lanes[lane] = point.x;
+    y.back().lanes[lane] = point.y;
+    z.back().lanes[lane] = point.z;
+    count++;
+}
+
+PointF VertexStream::operator[](size_t index) const
+{
+    return {xData()[index], yData()[index], zData()[index], 1.f};
+}
+
+void VertexStream::reserve(size_t size)
+{
+    size_t blocks = (size + VERTEX_STREAM_WIDTH - 1) / VERTEX_STREAM_WIDTH;
+    x.reserve(blocks);
+    y.reserve(blocks);
+    z.reserve(blocks);
+}
+
+void VertexStream::clear(void)
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    mappedX = mappedY = mappedZ = nullptr;
+    count = 0;
+}
+
+void VertexStream::map(const VertexLanes *pX, const VertexLanes *pY, const VertexLanes *pZ, size_t pCount)
+{
+    clear();
+    mappedX = pX;
+    mappedY = pY;
+    mappedZ = pZ;
+    count = pCount;
+}
+
+void VertexStream::own(void)
+{
+    if (!mappedX)
+        return;
+
+    size_t blocks = blockCount();
+    x.assign(mappedX, mappedX + blocks);
+    y.assign(mappedY, mappedY + blocks);
+    z.assign(mappedZ, mappedZ + blocks);
+    mappedX = mappedY = mappedZ = nullptr;
+}
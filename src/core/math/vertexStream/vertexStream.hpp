@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "../mathUtils.hpp"
+
+#define VERTEX_STREAM_WIDTH 8
+#define VERTEX_STREAM_ALIGNMENT 32
+
+// one register of the widest batch kernel, std::vector and FrameArena both honour the alignment
+typedef struct alignas(VERTEX_STREAM_ALIGNMENT)
+{
+    float lanes[VERTEX_STREAM_WIDTH];
+} VertexLanes;
+
+// Positions as separate x, y and z streams, w is always 1. The streams are padded with zeros to
+// a multiple of VERTEX_STREAM_WIDTH, so the batch kernels never need a scalar tail. Like a
+// MeshArray the streams can also be read in place from a mapped mesh file.
+class VertexStream
+{
+public:
+    void push_back(PointF point);
+    PointF operator[](size_t index) const;
+    size_t size(void) const { return count; }
+    size_t blockCount(void) const { return (count + VERTEX_STREAM_WIDTH - 1) / VERTEX_STREAM_WIDTH; }
+    void reserve(size_t size);
+    void clear(void);
+    void map(const VertexLanes *x, const VertexLanes *y, const VertexLanes *z, size_t count);
+
+    const float *xData(void) const { return (mappedX ? mappedX : x.data())->lanes; }
+    const float *yData(void) const { return (mappedY ? mappedY : y.data())->lanes; }
+    const float *zData(void) const { return (mappedZ ? mappedZ : z.data())->lanes; }
+
+private:
+    std::vector<VertexLanes> x, y, z;
+    const VertexLanes *mappedX = nullptr, *mappedY = nullptr, *mappedZ = nullptr;
+    size_t count = 0;
+
+    void own(void);
+};
@@ -0,0 +1,129 @@
+#include "meshFile.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + VERTEX_STREAM_ALIGNMENT - 1) & ~(uint64_t)(VERTEX_STREAM_ALIGNMENT - 1);
+}
+
+MeshFile::MeshFile(void *pMemory, size_t pSize) : memory(pMemory), size(pSize)
+{
+}
+
+MeshFile::~MeshFile()
+{
+    munmap(memory, size);
+}
+
+std::shared_ptr<MeshFile> MeshFile::map(const std::string &path)
+{
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return nullptr;
+
+    struct stat status;
+    void *memory = MAP_FAILED;
+    if (fstat(file, &status) == 0 && status.st_size >= (off_t)sizeof(MeshFileHeader))
+        memory = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping keeps the file alive on its own
+    close(file);
+    if (memory == MAP_FAILED)
+        return nullptr;
+
+    std::shared_ptr<MeshFile> meshFile(new MeshFile(memory, status.st_size));
+    if (!meshFile->isValid())
+        return nullptr;
+    return meshFile;
+}
+
+bool MeshFile::isValid(void) const
+{
+    const MeshFileHeader &file = header();
+    if (file.magic != MESH_FILE_MAGIC || file.version != MESH_FILE_VERSION)
+        return false;
+
+    uint64_t streamSize = ((uint64_t)file.vertexCount + VERTEX_STREAM_WIDTH - 1) / VERTEX_STREAM_WIDTH * sizeof(VertexLanes);
+    std::array<std::array<uint64_t, 2>, 6> blocks = {{
+        {file.vertexX, streamSize},
+        {file.vertexY, streamSize},
+        {file.vertexZ, streamSize},
+        {file.normals, (uint64_t)file.normalCount * sizeof(PointF)},
+        {file.vertexIndex, (uint64_t)file.triangleCount * sizeof(std::array<uint32_t, 3>)},
+        {file.normalIndex, (uint64_t)file.triangleCount * sizeof(uint32_t)},
+    }};
+    for (auto &block : blocks)
+    {
+        if (block[0] % VERTEX_STREAM_ALIGNMENT || block[0] > size || block[1] > size - block[0])
+            return false;
+    }
+
+    // indices are used without checks while drawing
+    auto vertexIndex = block<std::array<uint32_t, 3>>(file.vertexIndex);
+    auto normalIndex = block<uint32_t>(file.normalIndex);
+    for (uint32_t i = 0; i < file.triangleCount; i++)
+    {
+        if (vertexIndex[i][0] >= file.vertexCount || vertexIndex[i][1] >= file.vertexCount || vertexIndex[i][2] >= file.vertexCount ||
+            normalIndex[i] >= file.normalCount)
+            return false;
+    }
+    return true;
+}
+
+bool MeshFile::write(const std::string &path, const std::vector<PointF> &vertices, const std::vector<PointF> &normals,
+                     const std::vector<std::array<uint32_t, 3>> &vertexIndex, const std::vector<uint32_t> &normalIndex)
+{
+    VertexStream stream;
+    stream.reserve(vertices.size());
+    for (auto &vertex : vertices)
+    {
+        stream.push_back(vertex);
+    }
+
+    // padding included, so no uninitialised memory ends up in the file
+    MeshFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MESH_FILE_MAGIC;
+    header.version = MESH_FILE_VERSION;
+    header.vertexCount = stream.size();
+    header.normalCount = normals.size();
+    header.triangleCount = vertexIndex.size();
+    header.bounds = Bounds::boxFromPoints(stream);
+    header.boundingSphere = Bounds::sphereFromPoints(stream, header.bounds);
+
+    uint64_t streamSize = stream.blockCount() * sizeof(VertexLanes);
+    header.vertexX = alignOffset(sizeof(MeshFileHeader));
+    header.vertexY = header.vertexX + streamSize;
+    header.vertexZ = header.vertexY + streamSize;
+    header.normals = header.vertexZ + streamSize;
+    header.vertexIndex = alignOffset(header.normals + normals.size() * sizeof(PointF));
+    header.normalIndex = alignOffset(header.vertexIndex + vertexIndex.size() * sizeof(std::array<uint32_t, 3>));
+
+    std::vector<unsigned char> data(header.normalIndex + normalIndex.size() * sizeof(uint32_t), 0);
+    auto copy = [&data](uint64_t offset, const void *source, size_t size)
+    {
+        if (size)
+            std::copy((const unsigned char *)source, (const unsigned char *)source + size, data.begin() + offset);
+    };
+    copy(0, &header, sizeof(header));
+    if (streamSize)
+    {
+        copy(header.vertexX, stream.xData(), streamSize);
+        copy(header.vertexY, stream.yData(), streamSize);
+        copy(header.vertexZ, stream.zData(), streamSize);
+    }
+    copy(header.normals, normals.data(), normals.size() * sizeof(PointF));
+    copy(header.vertexIndex, vertexIndex.data(), vertexIndex.size() * sizeof(std::array<uint32_t, 3>));
+    copy(header.normalIndex, normalIndex.data(), normalIndex.size() * sizeof(uint32_t));
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && written;
+}
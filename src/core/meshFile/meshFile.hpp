@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../math/bounds/bounds.hpp"
+#include "../math/vertexStream/vertexStream.hpp"
+
+#define MESH_FILE_MAGIC 0x4853454D // "MESH"
+#define MESH_FILE_VERSION 1
+
+// Every block starts at a multiple of VERTEX_STREAM_ALIGNMENT, offsets are in bytes from the
+// start of the file. Vertices are stored as padded VertexStream x, y and z streams, normals as
+// PointF, and each triangle has three vertex indices and one normal index. Files are only
+// read back by the machine type that wrote them.
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t normalCount;
+    uint32_t triangleCount;
+    uint32_t reserved;
+    uint64_t vertexX, vertexY, vertexZ;
+    uint64_t normals;
+    uint64_t vertexIndex;
+    uint64_t normalIndex;
+    BoundingBox bounds;
+    BoundingSphere boundingSphere;
+} MeshFileHeader;
+
+// A mesh file mapped read only, its blocks are used in place and stay valid while the MeshFile
+// is alive.
+class MeshFile
+{
+public:
+    ~MeshFile();
+    MeshFile(const MeshFile &) = delete;
+    MeshFile &operator=(const MeshFile &) = delete;
+
+    // nullptr when the file can not be mapped or is not a valid mesh file
+    static std::shared_ptr<MeshFile> map(const std::string &path);
+    static bool write(const std::string &path, const std::vector<PointF> &vertices, const std::vector<PointF> &normals,
+                      const std::vector<std::array<uint32_t, 3>> &vertexIndex, const std::vector<uint32_t> &normalIndex);
+
+    const MeshFileHeader &header(void) const { return *static_cast<const MeshFileHeader *>(memory); }
+
+    template <typename T>
+    const T *block(uint64_t offset) const
+    {
+        return reinterpret_cast<const T *>(static_cast<const unsigned char *>(memory) + offset);
+    }
+
+private:
+    void *memory;
+    size_t size;
+
+    MeshFile(void *memory, size_t size);
+    bool isValid(void) const;
+};
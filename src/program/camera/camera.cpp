@@ -11,6 +11,19 @@ Camera::Camera(float pZNear)
     MathUtils::setMatrixAsIdentity(transformMatrix);
     MathUtils::setMatrixAsIdentity(rotationMatrix);
     MathUtils::setMatrixAsIdentity(translationMatrix);
+    updateProjectionMatrix();
+    updateFrustumPlanes();
+}
+
+void Camera::setProjection(float pFieldOfView, float pAspectRatio, float pFarPlane)
+{
+    if (pFieldOfView == fieldOfView && pAspectRatio == aspectRatio && pFarPlane == farPlane)
+        return;
+
+    fieldOfView = pFieldOfView;
+    aspectRatio = pAspectRatio;
+    farPlane = pFarPlane;
+    transformDirty = true;
 }
 
 void Camera::moveForward(float deltaTime)
@@ -34,6 +47,50 @@ void Camera::recalculateTransformMatrix()
     MathUtils::multiplyMatrix(transformMatrix, translationMatrix);
     MathUtils::multiplyMatrix(transformMatrix, rotationMatrix);
     MathUtils::multiplyMatrix(transformMatrix, scaleMatrix);
+    updateProjectionMatrix();
+    updateFrustumPlanes();
+}
+
+void Camera::updateProjectionMatrix(void)
+{
+    float nearPlane = frustrum.z;
+    float scaleX = 1.f / tanf(fieldOfView / 2);
+    float depthScale = farPlane / (farPlane - nearPlane);
+
+    // w keeps the view depth
+    projectionMatrix[0] = {scaleX, 0, 0, 0};
+    projectionMatrix[1] = {0, scaleX * aspectRatio, 0, 0};
+    projectionMatrix[2] = {0, 0, depthScale, 1};
+    projectionMatrix[3] = {0, 0, -nearPlane * depthScale, 0};
+}
+
+void Camera::updateFrustumPlanes(void)
+{
+    PointF viewProjection[4];
+    MathUtils::copyMatrix(viewProjection, transformMatrix);
+    MathUtils::multiplyMatrix(viewProjection, projectionMatrix);
+
+    // every clip coordinate is the dot product of the world point with a column, so the clip
+    // planes -w <= x <= w, -w <= y <= w and 0 <= z <= w are sums of columns in world space
+    PointF columnX = {viewProjection[0].x, viewProjection[1].x, viewProjection[2].x, viewProjection[3].x};
+    PointF columnY = {viewProjection[0].y, viewProjection[1].y, viewProjection[2].y, viewProjection[3].y};
+    PointF columnZ = {viewProjection[0].z, viewProjection[1].z, viewProjection[2].z, viewProjection[3].z};
+    PointF columnW = {viewProjection[0].w, viewProjection[1].w, viewProjection[2].w, viewProjection[3].w};
+    PointF planes[FRUSTUM_PLANE_COUNT] = {
+        columnW + columnX,
+        columnW - columnX,
+        columnW + columnY,
+        columnW - columnY,
+        columnZ,
+        columnW - columnZ,
+    };
+
+    for (int i = 0; i < FRUSTUM_PLANE_COUNT; i++)
+    {
+        PointF &plane = planes[i];
+        float length = sqrtf(plane.dot(plane));
+        frustumPlanes.planes[i] = {plane.x / length, plane.y / length, plane.z / length, plane.w / length};
+    }
 }
 
 PointF Camera::getForwardVector()
@@ -1,19 +1,44 @@
 #pragma once
 #include "../object3D/object3d.hpp"
 #include "../../core/math/vector/vector3.hpp"
+#include "../../core/math/bounds/bounds.hpp"
+
+#define RASTER_MODE_SCANLINE 0
+#define RASTER_MODE_TILED 1
+#define RASTER_MODE_SPAN_BUFFER 2
+
+// horizontal, in radians, a 100 pixel focal length on the 320 pixel wide view
+#define CAMERA_FIELD_OF_VIEW 2.0243940f
+#define CAMERA_ASPECT_RATIO (4.f / 3.f)
+#define CAMERA_FAR 1000.f
 
 class Camera : public Object3D
 {
 protected:
     void recalculateTransformMatrix() override;
+    void updateProjectionMatrix(void);
+    void updateFrustumPlanes(void);
 
 public:
     PointF frustrum;
+    // changed through setProjection() so the matrices know they are stale
+    float fieldOfView = CAMERA_FIELD_OF_VIEW;
+    float aspectRatio = CAMERA_ASPECT_RATIO;
+    float farPlane = CAMERA_FAR;
+    // view to clip space, x and y end up in [-w, w] and z in [0, w] between frustrum.z and farPlane
+    PointF projectionMatrix[4] = {0};
+    // world space planes of the view volume, refreshed with the transform matrix
+    Frustum frustumPlanes;
     bool wireframe = false;
     bool drawNormals = false;
     bool backFaceCulling = true;
+    int32_t rasterMode = RASTER_MODE_TILED;
+    bool guardBand = true;
+    // shapes whose bounding sphere covers fewer pixels than this are not drawn
+    float cullScreenSize = 1.f;
     float speed = 200.f;
     Camera(float zNear = 50);
+    void setProjection(float fieldOfView, float aspectRatio, float farPlane);
     void moveForward(float deltaTime);
     void strafe(float deltaTime);
     PointF getForwardVector();
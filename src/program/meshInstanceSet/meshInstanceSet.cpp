@@ -0,0 +1,51 @@
+#include "meshInstanceSet.hpp"
+
+MeshInstanceSet::MeshInstanceSet(const Shape &pMesh) : mesh(pMesh)
+{
+}
+
+uint32_t MeshInstanceSet::add(PointF matrix[4])
+{
+    uint32_t index = instances.size();
+    instances.emplace_back();
+    MathUtils::copyMatrix(instances.back().matrix, matrix);
+
+    // the padding lanes stay empty spheres at the origin, nobody reads their result
+    if (index % VERTEX_STREAM_WIDTH == 0)
+    {
+        centerX.push_back({0});
+        centerY.push_back({0});
+        centerZ.push_back({0});
+        radius.push_back({0});
+    }
+    updateSphere(index);
+    return index;
+}
+
+// same order as Object3D, rotated, scaled and then moved
+uint32_t MeshInstanceSet::add(PointF position, PointF rotation, float scale)
+{
+    Object3D transform;
+    transform.rotate(rotation);
+    transform.scale({scale, scale, scale});
+    transform.translate(position);
+    transform.update();
+    return add(transform.transformMatrix);
+}
+
+void MeshInstanceSet::setTransform(uint32_t index, PointF matrix[4])
+{
+    MathUtils::copyMatrix(instances[index].matrix, matrix);
+    updateSphere(index);
+}
+
+void MeshInstanceSet::updateSphere(uint32_t index)
+{
+    BoundingSphere sphere = Bounds::transformSphere(mesh.boundingSphere, instances[index].matrix);
+    uint32_t block = index / VERTEX_STREAM_WIDTH;
+    uint32_t lane = index % VERTEX_STREAM_WIDTH;
+    centerX[block].lanes[lane] = sphere.center.x;
+    centerY[block].lanes[lane] = sphere.center.y;
+    centerZ[block].lanes[lane] = sphere.center.z;
+    radius[block].lanes[lane] = sphere.radius;
+}
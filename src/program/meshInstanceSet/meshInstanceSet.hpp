@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "../shape/shape.hpp"
+
+typedef struct
+{
+    PointF matrix[4];
+} MeshInstance;
+
+// Many copies of one mesh, each with its own transform. The mesh is shared and never changed
+// through the set, it has to outlive it. The world bounding spheres of all instances are kept
+// as padded lanes like a VertexStream, so the render queue culls them in blocks.
+class MeshInstanceSet
+{
+public:
+    const Shape &mesh;
+    std::vector<MeshInstance> instances;
+
+    MeshInstanceSet(const Shape &mesh);
+
+    uint32_t add(PointF matrix[4]);
+    uint32_t add(PointF position, PointF rotation, float scale = 1.f);
+    void setTransform(uint32_t index, PointF matrix[4]);
+
+    size_t size(void) const { return instances.size(); }
+    size_t blockCount(void) const { return centerX.size(); }
+    const float *centerXData(void) const { return reinterpret_cast<const float *>(centerX.data()); }
+    const float *centerYData(void) const { return reinterpret_cast<const float *>(centerY.data()); }
+    const float *centerZData(void) const { return reinterpret_cast<const float *>(centerZ.data()); }
+    const float *radiusData(void) const { return reinterpret_cast<const float *>(radius.data()); }
+
+private:
+    std::vector<VertexLanes> centerX;
+    std::vector<VertexLanes> centerY;
+    std::vector<VertexLanes> centerZ;
+    std::vector<VertexLanes> radius;
+
+    void updateSphere(uint32_t index);
+};
@@ -1,5 +1,10 @@
 #include "object3d.hpp"
 
+static bool samePoint(PointF a, PointF b)
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
 Object3D::Object3D()
 {
     MathUtils::setMatrixAsIdentity(transformMatrix);
@@ -10,7 +15,12 @@ Object3D::Object3D()
 
 void Object3D::translate(PointF translation)
 {
+    // position may already have been moved by hand, the matrix tells what was applied
     this->position = translation;
+    if (samePoint(translationMatrix[3], translation))
+        return;
+
+    transformDirty = true;
     translationMatrix[0] = {1, 0, 0, 0};
     translationMatrix[1] = {0, 1, 0, 0};
     translationMatrix[2] = {0, 0, 1, 0};
@@ -19,6 +29,10 @@ void Object3D::translate(PointF translation)
 
 void Object3D::scale(PointF scale)
 {
+    if (samePoint({scaleMatrix[0].x, scaleMatrix[1].y, scaleMatrix[2].z}, scale))
+        return;
+
+    transformDirty = true;
     MathUtils::setMatrixAsIdentity(scaleMatrix);
     scaleMatrix[0].x = scale.x;
     scaleMatrix[1].y = scale.y;
@@ -36,6 +50,10 @@ void Object3D::recalculateTransformMatrix()
 
 void Object3D::rotate(PointF pRotation)
 {
+    if (samePoint(rotation, pRotation))
+        return;
+
+    transformDirty = true;
     rotation = pRotation;
     PointF rotationMatrixX[4] = {0};
 
@@ -66,5 +84,9 @@ void Object3D::rotate(PointF pRotation)
 
 void Object3D::update(void)
 {
+    if (!transformDirty)
+        return;
+
     recalculateTransformMatrix();
+    transformDirty = false;
 }
\ No newline at end of file
@@ -6,6 +6,8 @@ protected:
     PointF translationMatrix[4] = {0};
     PointF rotationMatrix[4] = {0};
     PointF scaleMatrix[4] = {0};
+    // set whenever position, rotation or scale change, update() only recalculates then
+    bool transformDirty = true;
     virtual void recalculateTransformMatrix();
 
 public:
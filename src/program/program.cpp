@@ -4,14 +4,19 @@
 #include "program.hpp"
 #include "../core/graphics/sprite/sprite.hpp"
 #include "shape/shape.hpp"
+#include "renderQueue/renderQueue.hpp"
+#include "staticWorld/staticWorld.hpp"
+#include "meshInstanceSet/meshInstanceSet.hpp"
+#include "sceneBvh/sceneBvh.hpp"
 #include <algorithm>
 #include <cmath>
 #include <vector>
 #include "../core/gameObject/gameObject.hpp"
 
-void showGUI(Camera &camera, bool &demoMode, bool &drawZBuffer)
+void showGUI(Camera &camera, TileRenderer &renderer, bool &demoMode, bool &drawZBuffer)
 {
     static bool showDebugWindow = true;
+    static bool simdSpans = true;
     if (ImGui::BeginMainMenuBar())
     {
         if (ImGui::BeginMenu("Debug"))
@@ -26,6 +31,19 @@ void showGUI(Camera &camera, bool &demoMode, bool &drawZBuffer)
             ImGui::Checkbox("Show Wireframe", &camera.wireframe);
             ImGui::Checkbox("BackFaceCuling", &camera.backFaceCulling);
             ImGui::Checkbox("Draw Normals", &camera.drawNormals);
+            ImGui::Checkbox("Guard Band Clipping", &camera.guardBand);
+            float fieldOfView = camera.fieldOfView;
+            if (ImGui::SliderAngle("Field of View", &fieldOfView, 30.f, 150.f))
+                camera.setProjection(fieldOfView, camera.aspectRatio, camera.farPlane);
+            ImGui::SliderFloat("Cull Screen Size", &camera.cullScreenSize, 0.f, 16.f);
+            ImGui::Combo("Rasterizer", &camera.rasterMode, "Scanline\0Tiled\0Span Buffer\0");
+            ImGui::Checkbox("Multi-threaded", &renderer.multiThreaded);
+            ImGui::Checkbox("Visibility Buffer", &renderer.visibilityBuffer);
+            if (ImGui::Checkbox("SIMD Spans", &simdSpans))
+            {
+                SpanKernel::drawSpan8 = simdSpans ? SpanKernel::selectSpanFunction() : SpanKernel::drawSpan8Scalar;
+                SpanKernel::drawIdSpan8 = simdSpans ? SpanKernel::selectIdSpanFunction() : SpanKernel::drawIdSpan8Scalar;
+            }
             ImGui::Checkbox("Draw ZBuffer", &drawZBuffer);
             ImGui::Checkbox("Demo Mode", &demoMode);
             ImGui::End();
@@ -84,6 +102,12 @@ void createPyramid(Shape &pyramid)
     pyramid.translate({0, 0, -800});
 }
 
+void createMarker(Shape &marker)
+{
+    marker.difuseColor = {0xFF, 0xFF, 0};
+    Shape::appendPiramid(marker, 10, 20, {0});
+}
+
 void Program::update(void)
 {
     GameObject parent;
@@ -103,7 +127,33 @@ void Program::update(void)
     createPyramid(pyramidPurple);
     createFloor(floor);
 
+    // only the floor moves, everything else is baked once
+    StaticWorld staticWorld;
+    staticWorld.add(house);
+    staticWorld.add(cross);
+    staticWorld.add(pyramidPurple);
+
+    // everything drawn as a whole shape is culled through the tree, the floor is refitted as it moves
+    SceneBvh sceneBvh;
+    floor.update();
+    int32_t floorHandle = sceneBvh.insert(floor);
+    for (auto &chunk : staticWorld.chunks)
+    {
+        sceneBvh.insert(chunk.shape);
+    }
+
+    // a row of markers sharing one mesh
+    Shape marker(1);
+    createMarker(marker);
+    MeshInstanceSet markers(marker);
+    for (int32_t i = 0; i < 20; i++)
+    {
+        markers.add({-300.f, 30.f, -400.f + i * 40.f}, {0, i * 0.3f, 0});
+    }
+
     Camera camera;
+    camera.setProjection(CAMERA_FIELD_OF_VIEW, (float)graphics->imageData.size.x / graphics->imageData.size.y, CAMERA_FAR);
+    RenderQueue renderQueue(graphics->renderer, graphics->spanBuffer, graphics->frameArena);
 
     // auto tempChecker = Sprite::createSplit({320, 240}, 115, {0x77, 0x77, 0xAA}, {0, 0x77, 0});
     auto tempChecker = Sprite::createSplit({320, 240}, 115, {0, 0, 0}, {0, 0, 0});
@@ -180,17 +230,15 @@ void Program::update(void)
         camera.update();
         checker->draw(graphics->imageData);
 
-        house.update();
-        cross.update();
         floor.update();
-        pyramidPurple.update();
+        sceneBvh.refit(floorHandle);
 
-        floor.draw(graphics->imageData, camera);
-        house.draw(graphics->imageData, camera);
-        cross.draw(graphics->imageData, camera);
-        pyramidPurple.draw(graphics->imageData, camera);
+        renderQueue.begin(camera);
+        sceneBvh.submit(renderQueue);
+        renderQueue.submit(markers);
+        renderQueue.flush();
         printFPS();
-        showGUI(camera, demoMode, drawZBuffer);
+        showGUI(camera, graphics->renderer, demoMode, drawZBuffer);
 
         if (drawZBuffer)
         {
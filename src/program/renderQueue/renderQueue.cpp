@@ -0,0 +1,228 @@
+#include "renderQueue.hpp"
+#include "../meshInstanceSet/meshInstanceSet.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Determinant of the x, y and w rows, the triple product of the view space vertices scaled by
+// the projection. Its sign is the eye vector test of the triangle, and it stays right for
+// vertices behind the eye, so faces can be culled before clipping.
+static inline float facing(const ClipVertex &a, const ClipVertex &b, const ClipVertex &c)
+{
+    return a.x * (b.y * c.w - c.y * b.w) - a.y * (b.x * c.w - c.x * b.w) + a.w * (b.x * c.y - c.x * b.y);
+}
+
+static PointI toPixel(PointF point)
+{
+    return {static_cast<int32_t>(point.x), static_cast<int32_t>(point.y), static_cast<int32_t>(point.z)};
+}
+
+RenderQueue::RenderQueue(TileRenderer &pRenderer, SpanBuffer &pSpanBuffer, FrameArena &pArena)
+    : renderer(pRenderer), spanBuffer(pSpanBuffer), arena(pArena)
+{
+}
+
+void RenderQueue::begin(Camera &pCamera)
+{
+    camera = &pCamera;
+    MathUtils::copyMatrix(viewMatrix, pCamera.transformMatrix);
+    MathUtils::copyMatrix(viewProjectionMatrix, pCamera.transformMatrix);
+    MathUtils::multiplyMatrix(viewProjectionMatrix, pCamera.projectionMatrix);
+    halfViewport = {renderer.imageData.size.x / 2.f, renderer.imageData.size.y / 2.f};
+    clipPlanes = CLIP_PLANES_DEPTH | (pCamera.guardBand ? CLIP_PLANES_GUARD_BAND : CLIP_PLANES_SCREEN);
+    // the reverse-Z depth of the rasterizers is 1 on the near plane of this camera
+    renderer.imageData.nearPlane = pCamera.frustrum.z;
+    spanBuffer.imageData.nearPlane = pCamera.frustrum.z;
+}
+
+void RenderQueue::submit(Shape &shape)
+{
+    submit(shape, Bounds::classify(camera->frustumPlanes, shape.worldBoundingSphere, shape.worldBounds));
+}
+
+void RenderQueue::submit(Shape &shape, int32_t visibility)
+{
+    if (visibility == CULL_OUTSIDE)
+        return;
+
+    float depth;
+    float size = screenSize(shape.worldBoundingSphere, depth);
+    if (size < camera->cullScreenSize)
+        return;
+
+    Shape &mesh = shape.selectLod(size);
+    items.push_back({depth, (uint32_t)items.size(), &mesh, mesh.transformMatrix, mesh.transformedNormals.data(), visibility == CULL_INSIDE});
+}
+
+// instances have no level of detail, they are all drawn with the one shared mesh
+void RenderQueue::submit(const MeshInstanceSet &instanceSet)
+{
+    auto blockCount = instanceSet.blockCount();
+    uint8_t *visibility = arena.allocate<uint8_t>(blockCount * VERTEX_STREAM_WIDTH);
+    Bounds::classifySpheres(camera->frustumPlanes, instanceSet.centerXData(), instanceSet.centerYData(),
+                            instanceSet.centerZData(), instanceSet.radiusData(), blockCount, visibility);
+
+    const float *radius = instanceSet.radiusData();
+    for (size_t i = 0; i < instanceSet.size(); i++)
+    {
+        if (visibility[i] == CULL_OUTSIDE)
+            continue;
+
+        BoundingSphere sphere = {{instanceSet.centerXData()[i], instanceSet.centerYData()[i], instanceSet.centerZData()[i]}, radius[i]};
+        float depth;
+        if (screenSize(sphere, depth) < camera->cullScreenSize)
+            continue;
+
+        items.push_back({depth, (uint32_t)items.size(), &instanceSet.mesh, instanceSet.instances[i].matrix, nullptr, visibility[i] == CULL_INSIDE});
+    }
+}
+
+// Diameter of the bounding sphere in pixels, anything around the eye counts as huge. Baked
+// shapes sit at the origin, the centre of the bounds is where the geometry is.
+float RenderQueue::screenSize(const BoundingSphere &sphere, float &depth)
+{
+    PointF origin = sphere.center;
+    origin.w = 1;
+    PointF view;
+    MathUtils::multiplyVertexByMatrix(view, origin, viewMatrix);
+    depth = view.z;
+
+    if (view.z > sphere.radius)
+        return 2 * sphere.radius * camera->projectionMatrix[1].y * halfViewport.y / view.z;
+    return FLT_MAX;
+}
+
+void RenderQueue::flush(void)
+{
+    // front to back, submission order breaks ties so the result does not depend on the sort
+    std::sort(items.begin(), items.end(), [](const RenderItem &a, const RenderItem &b)
+              { return a.depth != b.depth ? a.depth < b.depth : a.order < b.order; });
+
+    for (auto &item : items)
+    {
+        drawShape(*item.shape, item.model, item.normals, item.inside);
+    }
+    items.clear();
+
+    renderer.flush();
+    spanBuffer.flush();
+}
+
+// w is the view depth, it is kept as z for the depth plane
+PointF RenderQueue::toScreen(const ClipVertex &vertex)
+{
+    return {halfViewport.x + halfViewport.x * vertex.x / vertex.w,
+            halfViewport.y + halfViewport.y * vertex.y / vertex.w,
+            vertex.w};
+}
+
+void RenderQueue::drawShape(const Shape &shape, const PointF *model, const PointF *normals, bool inside)
+{
+    PointF modelMatrix[4] = {model[0], model[1], model[2], model[3]};
+    if (!normals)
+    {
+        PointF *worldNormals = arena.allocate<PointF>(shape.normals.size());
+        for (size_t i = 0; i < shape.normals.size(); i++)
+        {
+            PointF normal = shape.normals[i];
+            MathUtils::multiplyVertexByMatrix(worldNormals[i], normal, modelMatrix);
+        }
+        normals = worldNormals;
+    }
+
+    // object to clip space in one batch, the streams stay padded like the source
+    PointF modelViewProjection[4];
+    MathUtils::copyMatrix(modelViewProjection, modelMatrix);
+    MathUtils::multiplyMatrix(modelViewProjection, viewProjectionMatrix);
+
+    const VertexStream &vertices = shape.vertices;
+    auto vertexCount = vertices.size();
+    auto blockCount = vertices.blockCount();
+    float *clipX = arena.allocate<VertexLanes>(blockCount)->lanes;
+    float *clipY = arena.allocate<VertexLanes>(blockCount)->lanes;
+    float *clipZ = arena.allocate<VertexLanes>(blockCount)->lanes;
+    float *clipW = arena.allocate<VertexLanes>(blockCount)->lanes;
+    VertexKernel::transform(vertices.xData(), vertices.yData(), vertices.zData(), clipX, clipY, clipZ, clipW, blockCount, modelViewProjection);
+
+    // outcodes and screen positions are shared by every triangle using the vertex, only the
+    // vertices of clipped triangles are projected again
+    ClipVertex *clipVertices = arena.allocate<ClipVertex>(vertexCount);
+    uint32_t *outcodes = arena.allocate<uint32_t>(vertexCount);
+    PointF *screenVertices = arena.allocate<PointF>(vertexCount);
+
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        clipVertices[i] = {clipX[i], clipY[i], clipZ[i], clipW[i]};
+        // a shape inside the frustum needs no clipping at all
+        outcodes[i] = inside ? 0 : Clipper::outcode(clipVertices[i]);
+        // behind the eye there is no projection, those triangles always get clipped
+        if (clipW[i] > 0)
+            screenVertices[i] = toScreen(clipVertices[i]);
+    }
+
+    for (size_t i = 0; i < shape.vertexIndex.size(); i++)
+    {
+        auto index = shape.vertexIndex[i];
+        if (camera->backFaceCulling && facing(clipVertices[index[0]], clipVertices[index[1]], clipVertices[index[2]]) <= 0)
+            continue;
+
+        // all three vertices outside the same plane
+        if (outcodes[index[0]] & outcodes[index[1]] & outcodes[index[2]] & (CLIP_PLANES_SCREEN | CLIP_PLANES_DEPTH))
+            continue;
+
+        Color diffuse = shape.faceColors.empty() ? shape.difuseColor : shape.faceColors[i];
+        Surface surface = {normals[shape.normalIndex[i]], diffuse};
+        uint32_t crossed = (outcodes[index[0]] | outcodes[index[1]] | outcodes[index[2]]) & clipPlanes;
+        if (!crossed)
+        {
+            drawTriangle({screenVertices[index[0]], screenVertices[index[1]], screenVertices[index[2]]}, surface);
+            continue;
+        }
+
+        ClipPolygon polygon = {{clipVertices[index[0]], clipVertices[index[1]], clipVertices[index[2]]}, 3};
+        Clipper::clipPolygon(polygon, crossed);
+
+        PointF first = toScreen(polygon.vertices[0]);
+        PointF previous = toScreen(polygon.vertices[1]);
+        for (int32_t v = 2; v < polygon.count; v++)
+        {
+            PointF current = toScreen(polygon.vertices[v]);
+            drawTriangle({first, previous, current}, surface);
+            previous = current;
+        }
+    }
+}
+
+void RenderQueue::drawTriangle(const TriangleF &triangleF, const Surface &surface)
+{
+    ImageData &pImageData = renderer.imageData;
+
+    // lines and the scanline rasterizer work on whole pixels, the tiled one keeps sub-pixel precision
+    TriangleI triangle = {toPixel(triangleF[0]), toPixel(triangleF[1]), toPixel(triangleF[2])};
+
+    if (camera->drawNormals)
+    {
+        auto transformedNormalX = static_cast<int>(surface.normal.x * 10);
+        auto transformedNormalY = static_cast<int>(surface.normal.y * 10);
+
+        pImageData.drawLine({triangle[0].x, triangle[0].y}, {triangle[0].x + transformedNormalX, triangle[0].y + transformedNormalY});
+        pImageData.drawLine({triangle[1].x, triangle[1].y}, {triangle[1].x + transformedNormalX, triangle[1].y + transformedNormalY});
+        pImageData.drawLine({triangle[2].x, triangle[2].y}, {triangle[2].x + transformedNormalX, triangle[2].y + transformedNormalY});
+    }
+
+    if (camera->wireframe)
+    {
+        pImageData.drawLine(triangle[0], triangle[1], {255, 0, 0});
+        pImageData.drawLine(triangle[1], triangle[2], {0, 255, 0});
+        pImageData.drawLine(triangle[2], triangle[0], {0, 0, 255});
+        return;
+    }
+
+    // the tiled renderer shades on its own, possibly after visibility is resolved
+    if (camera->rasterMode == RASTER_MODE_TILED)
+        renderer.submit(triangleF, surface);
+    else if (camera->rasterMode == RASTER_MODE_SPAN_BUFFER)
+        spanBuffer.submit({triangleF, Shading::flat(surface)});
+    else
+        Shape::rasterizeTriangle({triangle, Shading::flat(surface)}, pImageData);
+}
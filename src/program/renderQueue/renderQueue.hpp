@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "../shape/shape.hpp"
+#include "../camera/camera.hpp"
+#include "../../core/graphics/rasterizer/tileRenderer.hpp"
+#include "../../core/graphics/rasterizer/spanBuffer.hpp"
+#include "../../core/graphics/clipper/clipper.hpp"
+#include "../../core/frameArena/frameArena.hpp"
+#include "../../core/math/vertexStream/vertexKernel.hpp"
+
+typedef struct
+{
+    float depth;
+    uint32_t order;
+    const Shape *shape;
+    // model matrix, and the normals already in world space or null to transform them while drawing
+    const PointF *model;
+    const PointF *normals;
+    bool inside;
+} RenderItem;
+
+class MeshInstanceSet;
+
+// Shapes are queued for a camera and drawn together by flush(). Everything that only depends
+// on the camera is computed once in begin(), and the queue is drawn front to back so the
+// depth test and the tile Hi-Z reject as much as possible of what comes later. Shapes whose
+// bounds are outside the camera frustum are dropped on submit, those inside skip clipping.
+// Instances of a shared mesh are culled together, a block of bounding spheres at a time.
+class RenderQueue
+{
+public:
+    RenderQueue(TileRenderer &renderer, SpanBuffer &spanBuffer, FrameArena &arena);
+
+    void begin(Camera &camera);
+    void submit(Shape &shape);
+    // for callers that already classified the shape against frustum(), e.g. by its parent volume
+    void submit(Shape &shape, int32_t visibility);
+    void submit(const MeshInstanceSet &instanceSet);
+    void flush(void);
+
+    const Frustum &frustum(void) const { return camera->frustumPlanes; }
+
+private:
+    TileRenderer &renderer;
+    SpanBuffer &spanBuffer;
+    FrameArena &arena;
+    std::vector<RenderItem> items;
+
+    const Camera *camera = nullptr;
+    PointF viewMatrix[4];
+    PointF viewProjectionMatrix[4];
+    PointF halfViewport;
+    uint32_t clipPlanes;
+
+    float screenSize(const BoundingSphere &sphere, float &depth);
+    void drawShape(const Shape &shape, const PointF *model, const PointF *normals, bool inside);
+    void drawTriangle(const TriangleF &triangle, const Surface &surface);
+    PointF toScreen(const ClipVertex &vertex);
+};
@@ -0,0 +1,253 @@
+#include "sceneBvh.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+static PointF centroid(const BoundingBox &box)
+{
+    return {(box.min.x + box.max.x) * 0.5f, (box.min.y + box.max.y) * 0.5f, (box.min.z + box.max.z) * 0.5f, 1.f};
+}
+
+static bool sameBox(const BoundingBox &a, const BoundingBox &b)
+{
+    return a.min.x == b.min.x && a.min.y == b.min.y && a.min.z == b.min.z &&
+           a.max.x == b.max.x && a.max.y == b.max.y && a.max.z == b.max.z;
+}
+
+// two sided Moller-Trumbore, FLT_MAX when the ray misses
+static float intersectTriangle(const Ray &ray, PointF a, PointF b, PointF c)
+{
+    PointF direction = ray.direction;
+    PointF edge1 = b - a;
+    PointF edge2 = c - a;
+    PointF p = direction.cross(edge2);
+    float determinant = edge1.dot(p);
+    if (fabsf(determinant) < FLT_EPSILON)
+        return FLT_MAX;
+
+    float inverse = 1.f / determinant;
+    PointF origin = ray.origin;
+    PointF s = origin - a;
+    float u = s.dot(p) * inverse;
+    if (u < 0 || u > 1)
+        return FLT_MAX;
+
+    PointF q = s.cross(edge1);
+    float v = direction.dot(q) * inverse;
+    if (v < 0 || u + v > 1)
+        return FLT_MAX;
+
+    float distance = edge2.dot(q) * inverse;
+    return distance >= 0 ? distance : FLT_MAX;
+}
+
+int32_t SceneBvh::insert(Shape &shape)
+{
+    objects.push_back(&shape);
+    leaves.push_back(-1);
+    dirty = true;
+    return objects.size() - 1;
+}
+
+// top down, split at the median centroid along the longest axis of the centroids
+void SceneBvh::build(void)
+{
+    nodes.clear();
+    nodes.reserve(objects.size() * 2);
+    buildOrder.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        buildOrder[i] = i;
+    }
+    if (!objects.empty())
+        buildNode(0, objects.size(), -1);
+    dirty = false;
+}
+
+int32_t SceneBvh::buildNode(int32_t first, int32_t count, int32_t parent)
+{
+    int32_t index = nodes.size();
+    nodes.push_back({{{0}, {0}}, parent, -1, -1, -1});
+
+    if (count == 1)
+    {
+        int32_t object = buildOrder[first];
+        nodes[index].bounds = objects[object]->worldBounds;
+        nodes[index].object = object;
+        leaves[object] = index;
+        return index;
+    }
+
+    PointF firstCentroid = centroid(objects[buildOrder[first]]->worldBounds);
+    BoundingBox centroids = {firstCentroid, firstCentroid};
+    for (int32_t i = first; i < first + count; i++)
+    {
+        PointF point = centroid(objects[buildOrder[i]]->worldBounds);
+        centroids = Bounds::merge(centroids, {point, point});
+    }
+    PointF extent = centroids.max - centroids.min;
+    int32_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+
+    auto begin = buildOrder.begin() + first;
+    int32_t half = count / 2;
+    std::nth_element(begin, begin + half, begin + count, [this, axis](int32_t a, int32_t b)
+                     {
+                         PointF centerA = centroid(objects[a]->worldBounds);
+                         PointF centerB = centroid(objects[b]->worldBounds);
+                         return axis == 0 ? centerA.x < centerB.x : axis == 1 ? centerA.y < centerB.y : centerA.z < centerB.z; });
+
+    int32_t left = buildNode(first, half, index);
+    int32_t right = buildNode(first + half, count - half, index);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    nodes[index].bounds = Bounds::merge(nodes[left].bounds, nodes[right].bounds);
+    return index;
+}
+
+// the parents only change until one of them already covers the new bounds exactly
+void SceneBvh::refit(int32_t handle)
+{
+    if (dirty)
+        return;
+
+    int32_t index = leaves[handle];
+    nodes[index].bounds = objects[handle]->worldBounds;
+    for (index = nodes[index].parent; index >= 0; index = nodes[index].parent)
+    {
+        BoundingBox bounds = Bounds::merge(nodes[nodes[index].left].bounds, nodes[nodes[index].right].bounds);
+        if (sameBox(bounds, nodes[index].bounds))
+            break;
+        nodes[index].bounds = bounds;
+    }
+}
+
+void SceneBvh::submit(RenderQueue &renderQueue)
+{
+    if (dirty)
+        build();
+    if (!nodes.empty())
+        submitNode(renderQueue, 0, FRUSTUM_PLANES_ALL);
+}
+
+void SceneBvh::submitNode(RenderQueue &renderQueue, int32_t index, uint32_t planeMask)
+{
+    const BvhNode &node = nodes[index];
+    int32_t visibility = Bounds::classifyBox(renderQueue.frustum(), node.bounds, planeMask);
+    if (visibility == CULL_OUTSIDE)
+        return;
+    if (visibility == CULL_INSIDE)
+    {
+        submitInside(renderQueue, index);
+        return;
+    }
+
+    // a leaf on the border still gets the tighter sphere test of the queue
+    if (node.left < 0)
+    {
+        renderQueue.submit(*objects[node.object]);
+        return;
+    }
+    submitNode(renderQueue, node.left, planeMask);
+    submitNode(renderQueue, node.right, planeMask);
+}
+
+void SceneBvh::submitInside(RenderQueue &renderQueue, int32_t index)
+{
+    const BvhNode &node = nodes[index];
+    if (node.left < 0)
+    {
+        renderQueue.submit(*objects[node.object], CULL_INSIDE);
+        return;
+    }
+    submitInside(renderQueue, node.left);
+    submitInside(renderQueue, node.right);
+}
+
+Shape *SceneBvh::raycast(PointF origin, PointF direction, float maxDistance, float &distance)
+{
+    if (dirty)
+        build();
+
+    Ray ray = {origin, direction, {1.f / direction.x, 1.f / direction.y, 1.f / direction.z}};
+    Shape *hit = nullptr;
+    distance = maxDistance;
+    if (!nodes.empty())
+        raycastNode(ray, 0, distance, hit);
+    return hit;
+}
+
+// the nearer child first, so the hit found there can prune the other one
+void SceneBvh::raycastNode(const Ray &ray, int32_t index, float &nearest, Shape *&hit)
+{
+    const BvhNode &node = nodes[index];
+    if (node.left < 0)
+    {
+        float distance = raycastShape(ray, *objects[node.object], nearest);
+        if (distance < nearest)
+        {
+            nearest = distance;
+            hit = objects[node.object];
+        }
+        return;
+    }
+
+    int32_t children[2] = {node.left, node.right};
+    float distances[2];
+    bool hits[2];
+    for (int32_t i = 0; i < 2; i++)
+    {
+        hits[i] = Bounds::intersectRay(nodes[children[i]].bounds, ray.origin, ray.inverseDirection, nearest, distances[i]);
+    }
+
+    int32_t first = hits[1] && (!hits[0] || distances[1] < distances[0]) ? 1 : 0;
+    for (int32_t i = 0; i < 2; i++)
+    {
+        int32_t child = (first + i) & 1;
+        if (hits[child] && distances[child] <= nearest)
+            raycastNode(ray, children[child], nearest, hit);
+    }
+}
+
+float SceneBvh::raycastShape(const Ray &ray, Shape &shape, float maxDistance)
+{
+    float distance;
+    if (!Bounds::intersectRay(shape.worldBounds, ray.origin, ray.inverseDirection, maxDistance, distance))
+        return FLT_MAX;
+
+    float nearest = FLT_MAX;
+    for (size_t i = 0; i < shape.vertexIndex.size(); i++)
+    {
+        auto index = shape.vertexIndex[i];
+        PointF world[3];
+        for (int v = 0; v < 3; v++)
+        {
+            PointF local = shape.vertices[index[v]];
+            MathUtils::multiplyVertexByMatrix(world[v], local, shape.transformMatrix);
+        }
+        nearest = std::min(nearest, intersectTriangle(ray, world[0], world[1], world[2]));
+    }
+    return nearest;
+}
+
+void SceneBvh::overlap(const BoundingBox &box, std::vector<Shape *> &results)
+{
+    if (dirty)
+        build();
+    if (!nodes.empty())
+        overlapNode(box, 0, results);
+}
+
+void SceneBvh::overlapNode(const BoundingBox &box, int32_t index, std::vector<Shape *> &results)
+{
+    const BvhNode &node = nodes[index];
+    if (!Bounds::overlaps(box, node.bounds))
+        return;
+
+    if (node.left < 0)
+    {
+        results.push_back(objects[node.object]);
+        return;
+    }
+    overlapNode(box, node.left, results);
+    overlapNode(box, node.right, results);
+}
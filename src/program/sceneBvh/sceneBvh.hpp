@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "../shape/shape.hpp"
+#include "../renderQueue/renderQueue.hpp"
+
+typedef struct
+{
+    BoundingBox bounds;
+    int32_t parent;
+    // children of an inner node, -1 for a leaf
+    int32_t left, right;
+    // the object of a leaf
+    int32_t object;
+} BvhNode;
+
+typedef struct
+{
+    PointF origin, direction, inverseDirection;
+} Ray;
+
+// Bounding volume hierarchy over the world bounds of the scene shapes, one shape per leaf. The
+// render walk drops whole subtrees outside the frustum and stops testing below nodes that are
+// inside, so culling costs about as much as what is visible. Moving shapes are refitted in
+// place, the tree is only rebuilt when shapes are inserted. Shapes have to be updated before
+// they are inserted or refitted, and have to outlive the tree.
+class SceneBvh
+{
+public:
+    std::vector<BvhNode> nodes;
+
+    // returns the handle for refit()
+    int32_t insert(Shape &shape);
+    void build(void);
+    void refit(int32_t handle);
+
+    void submit(RenderQueue &renderQueue);
+    // nearest triangle hit in front of origin, distance is in multiples of direction
+    Shape *raycast(PointF origin, PointF direction, float maxDistance, float &distance);
+    // shapes whose world bounds touch box, appended to results
+    void overlap(const BoundingBox &box, std::vector<Shape *> &results);
+
+private:
+    std::vector<Shape *> objects;
+    // leaf node of each object
+    std::vector<int32_t> leaves;
+    std::vector<int32_t> buildOrder;
+    bool dirty = false;
+
+    int32_t buildNode(int32_t first, int32_t count, int32_t parent);
+    void submitNode(RenderQueue &renderQueue, int32_t index, uint32_t planeMask);
+    void submitInside(RenderQueue &renderQueue, int32_t index);
+    void raycastNode(const Ray &ray, int32_t index, float &nearest, Shape *&hit);
+    void overlapNode(const BoundingBox &box, int32_t index, std::vector<Shape *> &results);
+    static float raycastShape(const Ray &ray, Shape &shape, float maxDistance);
+};
@@ -14,8 +14,6 @@ Shape::Shape(int vertexNum)
 {
     difuseColor = {0xFF, 0xFF, 0xFF};
     vertices.reserve(vertexNum);
-    transformedVertices.reserve(vertexNum);
-    projectedVertices.reserve(vertexNum);
 
     MathUtils::setMatrixAsIdentity(transformMatrix);
     MathUtils::setMatrixAsIdentity(rotationMatrix);
@@ -27,193 +25,49 @@ Shape::~Shape()
 {
 }
 
-bool Shape::isBackFace(PointF normal, PointF vector)
-{
-    auto angle = acosf(normal.normalize().dot(vector.normalize()));
-    return angle < 1.4f;
-}
-
-void Shape::clipTriangleGeneric(TrianglesF &triangles,
-                                TriangleF triangle,
-                                float boundary,
-                                std::vector<uint32_t> &localNormalIndex,
-                                int32_t normalIndex,
-                                std::function<bool(PointF, float)> compareFunc,
-                                std::function<bool(PointF, PointF)> sortFunc,
-                                PointF planeNormal,
-                                PointF planePoint)
+// static shapes cost nothing here, everything below only depends on the transform
+void Shape::update(void)
 {
-    int vertexInside = 0;
-    for (auto &vertex : triangle)
-    {
-        if (compareFunc(vertex, boundary))
-            vertexInside++;
-    }
-    // discard triangle
-    if (vertexInside == 0)
-        return;
-
-    if (vertexInside == 3)
-    {
-        triangles.emplace_back(triangle);
-        localNormalIndex.emplace_back(normalIndex);
-        return;
-    }
-
-    if (vertexInside == 1)
-    {
-        std::sort(triangle.begin(), triangle.end(), sortFunc);
-        // the normal of the zNear plane is hardcoded. Also the vector that locates the plane.
-        triangle[1] = MathUtils::intersectionPoint((triangle[0] - triangle[1]), triangle[1], planeNormal, planePoint);
-        triangle[2] = MathUtils::intersectionPoint((triangle[0] - triangle[2]), triangle[2], planeNormal, planePoint);
-        triangles.emplace_back(triangle);
-        localNormalIndex.emplace_back(normalIndex);
+    if (!transformDirty)
         return;
-    }
 
-    if (vertexInside == 2)
+    Object3D::update();
+    transform();
+    for (auto &lod : lodMeshes)
     {
-        std::sort(triangle.begin(), triangle.end(), sortFunc);
-        TriangleF newTriangle = {0};
-        newTriangle[0] = triangle[1];
-        newTriangle[1] = MathUtils::intersectionPoint((triangle[0] - triangle[2]), triangle[2], planeNormal, planePoint);
-        newTriangle[2] = MathUtils::intersectionPoint((triangle[1] - triangle[2]), triangle[1], planeNormal, planePoint);
-
-        triangle[2] = MathUtils::intersectionPoint((triangle[0] - triangle[2]), triangle[2], planeNormal, planePoint);
-        triangles.emplace_back(triangle);
-        localNormalIndex.emplace_back(normalIndex);
-
-        triangles.emplace_back(newTriangle);
-        localNormalIndex.emplace_back(normalIndex);
+        MathUtils::copyMatrix(lod.transformMatrix, transformMatrix);
+        lod.transform();
     }
+    worldBounds = Bounds::transformBox(bounds, transformMatrix);
+    worldBoundingSphere = Bounds::transformSphere(boundingSphere, transformMatrix);
 }
 
-void Shape::update(void)
+void Shape::updateBounds(void)
 {
-    Object3D::recalculateTransformMatrix();
-    transform();
+    bounds = Bounds::boxFromPoints(vertices);
+    boundingSphere = Bounds::sphereFromPoints(vertices, bounds);
+    // the world bounds and normals have to follow the new geometry
+    transformDirty = true;
 }
 
-void Shape::draw(ImageData &pImageData, Camera camera)
+// screen sizes have to be added from the finest level to the coarsest
+void Shape::addLod(const Shape &mesh, float screenSize)
 {
-    TrianglesF clippedTriangles;
-    TrianglesF clippedTriangles2;
-
-    TrianglesI projectedVerticesLocal;
-    std::vector<uint32_t> localNormalIndex;
-    std::vector<uint32_t> localNormalIndex2;
-    std::vector<PointF> transformedVerticesLocal;
-
-    transformedVerticesLocal.reserve(transformedVertices.size());
-
-    for (auto i = 0; i < transformedVertices.size(); i++)
-    {
-        MathUtils::multiplyVertexByMatrix(transformedVerticesLocal[i], transformedVertices[i], camera.transformMatrix);
-    }
-
-    PointF normal = {1, 0, 0};
-    normal = normal.normalize();
-    for (int i = 0; i < vertexIndex.size(); i++)
-    {
-        auto index = vertexIndex[i];
-        PointF p1 = {transformedVerticesLocal[index[0]].x, transformedVerticesLocal[index[0]].y, transformedVerticesLocal[index[0]].z};
-        PointF p2 = {transformedVerticesLocal[index[1]].x, transformedVerticesLocal[index[1]].y, transformedVerticesLocal[index[1]].z};
-        PointF p3 = {transformedVerticesLocal[index[2]].x, transformedVerticesLocal[index[2]].y, transformedVerticesLocal[index[2]].z};
-        clipTriangleGeneric(
-            clippedTriangles, {p1, p2, p3}, camera.frustrum.x, localNormalIndex, normalIndex[i], [](PointF a, float b) -> bool
-            { return a.x > b; },
-            [](PointF a, PointF b) -> bool
-            { return a.x > b.x; },
-            normal,
-            {camera.frustrum.x, 0, 0});
-    }
-
-    normal = {-1, 0, 0};
-    normal = normal.normalize();
-    for (int i = 0; i < clippedTriangles.size(); i++)
-    {
-        clipTriangleGeneric(
-            clippedTriangles2, clippedTriangles[i], camera.frustrum.w, localNormalIndex2, localNormalIndex[i], [](PointF a, float b) -> bool
-            { return a.x < b; },
-            [](PointF a, PointF b) -> bool
-            { return a.x < b.x; },
-            normal,
-            {camera.frustrum.w - 30, 0, 0});
-    }
-
-    clippedTriangles.clear();
-    localNormalIndex.clear();
-
-    for (int i = 0; i < clippedTriangles2.size(); i++)
-    {
-        clipTriangleGeneric(
-            clippedTriangles, clippedTriangles2[i], camera.frustrum.z, localNormalIndex, localNormalIndex2[i], [](PointF a, float b) -> bool
-            { return a.z > b; },
-            [](PointF a, PointF b) -> bool
-            { return a.z > b.z; },
-            {0, 0, 1},
-            {0, 0, camera.frustrum.z});
-    }
-
-    clippedTriangles2.clear();
-    localNormalIndex2.clear();
-
-    normal = {0, 0, -1};
-    normal = normal.normalize();
-
-    for (int i = 0; i < clippedTriangles.size(); i++)
-    {
-        clipTriangleGeneric(
-            clippedTriangles2, clippedTriangles[i], 1000, localNormalIndex2, localNormalIndex[i], [](PointF a, float b) -> bool
-            { return a.z < b; },
-            [](PointF a, PointF b) -> bool
-            { return a.z < b.z; },
-            normal,
-            {0, 0, 1000});
-    }
-
-    clippedTriangles = clippedTriangles2;
-    localNormalIndex = localNormalIndex2;
+    lodMeshes.push_back(mesh);
+    lodMeshes.back().transformedNormals.resize(mesh.normals.size());
+    lodSizes.push_back(screenSize);
+    transformDirty = true;
+}
 
-    project(projectedVerticesLocal, clippedTriangles, 100);
+Shape &Shape::selectLod(float screenSize)
+{
+    int32_t levels = lodMeshes.size();
+    while (lodLevel < levels && screenSize < lodSizes[lodLevel] * (1.f - LOD_HYSTERESIS))
+        lodLevel++;
+    while (lodLevel > 0 && screenSize > lodSizes[lodLevel - 1] * (1.f + LOD_HYSTERESIS))
+        lodLevel--;
 
-    for (int i = 0; i < projectedVerticesLocal.size(); i++)
-    {
-        auto triangle = projectedVerticesLocal[i];
-        auto transformedNormal = transformedNormals[localNormalIndex[i]];
-        if (camera.backFaceCulling)
-            if (isBackFace(transformedNormal, camera.getForwardVector()))
-            {
-                continue;
-            }
-
-        if (camera.drawNormals)
-        {
-            auto transformedNormalX = static_cast<int>(transformedNormal.x * 10);
-            auto transformedNormalY = static_cast<int>(transformedNormal.y * 10);
-
-            pImageData.drawLine({triangle[0].x, triangle[0].y}, {triangle[0].x + transformedNormalX, triangle[0].y + transformedNormalY});
-            pImageData.drawLine({triangle[1].x, triangle[1].y}, {triangle[1].x + transformedNormalX, triangle[1].y + transformedNormalY});
-            pImageData.drawLine({triangle[2].x, triangle[2].y}, {triangle[2].x + transformedNormalX, triangle[2].y + transformedNormalY});
-        }
-
-        if (camera.wireframe)
-        {
-            pImageData.drawLine(triangle[0], triangle[1], {255, 0, 0});
-            pImageData.drawLine(triangle[1], triangle[2], {0, 255, 0});
-            pImageData.drawLine(triangle[2], triangle[0], {0, 0, 255});
-            continue;
-        }
-        Color color = {0, 0, 255};
-        auto component = transformedNormal.angleWith({1, 1, 1}) / M_PI;
-        color = {static_cast<unsigned char>(difuseColor.r * component),
-                 static_cast<unsigned char>(difuseColor.g * component),
-                 static_cast<unsigned char>(difuseColor.b * component)};
-
-        Triangle<int32_t> triangleI = {triangle, color};
-
-        rasterizeTriangle(triangleI, pImageData);
-    }
+    return lodLevel ? lodMeshes[lodLevel - 1] : *this;
 }
 
 void Shape::transform()
@@ -221,39 +75,35 @@ void Shape::transform()
     auto normalsSize = normals.size();
     for (auto i = 0; i < normalsSize; i++)
     {
-        MathUtils::multiplyVertexByMatrix(transformedNormals[i], normals[i], transformMatrix);
-    }
-    auto vertexSize = vertices.size();
-    for (auto i = 0; i < vertexSize; i++)
-    {
-        MathUtils::multiplyVertexByMatrix(transformedVertices[i], vertices[i], transformMatrix);
+        PointF normal = normals[i];
+        MathUtils::multiplyVertexByMatrix(transformedNormals[i], normal, transformMatrix);
     }
 }
 
-void Shape::project(float distance)
+bool Shape::loadMesh(Shape &shape, const std::string &path)
 {
-    auto size = transformedVertices.size();
-    for (int i = 0; i < size; i++)
+    auto file = MeshFile::map(path);
+    if (!file)
     {
-        projectedVertices[i].x = distance * transformedVertices[i].x / transformedVertices[i].z + 160;
-        projectedVertices[i].y = distance * transformedVertices[i].y / transformedVertices[i].z + 120;
-        projectedVertices[i].z = transformedVertices[i].z;
+        std::cout << "could not load mesh " << path << std::endl;
+        return false;
     }
-}
 
-void Shape::project(TrianglesI &pProjectedVertices, TrianglesF &triangles, float distance)
-{
-    for (auto &triangle : triangles)
-    {
-        TriangleI triangleD = {0};
-        for (int i = 0; i < triangleD.size(); ++i)
-        {
-            triangleD[i].x = static_cast<int32_t>(distance * triangle[i].x / triangle[i].z + 160);
-            triangleD[i].y = static_cast<int32_t>(distance * triangle[i].y / triangle[i].z + 120);
-            triangleD[i].z = static_cast<int32_t>(triangle[i].z);
-        }
-        pProjectedVertices.emplace_back(triangleD);
-    }
+    const MeshFileHeader &header = file->header();
+    shape.vertices.map(file->block<VertexLanes>(header.vertexX), file->block<VertexLanes>(header.vertexY),
+                       file->block<VertexLanes>(header.vertexZ), header.vertexCount);
+    shape.normals.map(file->block<PointF>(header.normals), header.normalCount);
+    shape.vertexIndex.map(file->block<std::array<uint32_t, 3>>(header.vertexIndex), header.triangleCount);
+    shape.normalIndex.map(file->block<uint32_t>(header.normalIndex), header.triangleCount);
+    shape.transformedNormals.resize(header.normalCount);
+    shape.faceColors.clear();
+
+    // the bounds are stored with the mesh, nothing has to be read to load it
+    shape.bounds = header.bounds;
+    shape.boundingSphere = header.boundingSphere;
+    shape.meshFile = file;
+    shape.transformDirty = true;
+    return true;
 }
 
 Shape Shape::createPyramid(float baseSize, float height, float zPosition)
@@ -270,11 +120,11 @@ Shape Shape::createPyramid(float baseSize, float height, float zPosition)
 void Shape::appendPiramid(Shape &shape, float baseSize, float height, PointF position)
 {
     uint32_t vertexOffset = shape.vertices.size();
-    shape.vertices.emplace_back(position + (PointF){-baseSize, 0, -baseSize, 1.f});
-    shape.vertices.emplace_back(position + (PointF){-baseSize, 0, baseSize, 1.f});
-    shape.vertices.emplace_back(position + (PointF){baseSize, 0, baseSize, 1.f});
-    shape.vertices.emplace_back(position + (PointF){baseSize, 0, -baseSize, 1.f});
-    shape.vertices.emplace_back(position + (PointF){0, -height, 0, 1.f});
+    shape.vertices.push_back(position + (PointF){-baseSize, 0, -baseSize, 1.f});
+    shape.vertices.push_back(position + (PointF){-baseSize, 0, baseSize, 1.f});
+    shape.vertices.push_back(position + (PointF){baseSize, 0, baseSize, 1.f});
+    shape.vertices.push_back(position + (PointF){baseSize, 0, -baseSize, 1.f});
+    shape.vertices.push_back(position + (PointF){0, -height, 0, 1.f});
 
     shape.vertexIndex.emplace_back(std::array<uint32_t, 3>({vertexOffset + 0, vertexOffset + 2, vertexOffset + 1}));
     shape.normals.emplace_back((shape.vertices[vertexOffset + 0] - shape.vertices[vertexOffset + 1]).cross((shape.vertices[vertexOffset + 0] - shape.vertices[vertexOffset + 2])).normalize());
@@ -302,8 +152,7 @@ void Shape::appendPiramid(Shape &shape, float baseSize, float height, PointF pos
 
     shape.transformedNormals.resize(shape.normals.size());
 
-    shape.transformedVertices.resize(shape.vertices.size());
-    shape.projectedVertices.resize(shape.vertices.size());
+    shape.updateBounds();
 
     shape.translate({0.f, 0.f, position.z});
 }
@@ -312,24 +161,23 @@ void Shape::appendQuad(Shape &shape, float cubeSize, PointF position)
 {
     uint32_t vertexOffset = shape.vertices.size();
 
-    shape.vertices.emplace_back(position + (PointF){-cubeSize, -cubeSize, 0, 1.f});
-    shape.vertices.emplace_back(position + (PointF){cubeSize, -cubeSize, 0, 1.f});
-    shape.vertices.emplace_back(position + (PointF){cubeSize, cubeSize, 0, 1.f});
-    shape.vertices.emplace_back(position + (PointF){-cubeSize, cubeSize, 0, 1.f});
+    shape.vertices.push_back(position + (PointF){-cubeSize, -cubeSize, 0, 1.f});
+    shape.vertices.push_back(position + (PointF){cubeSize, -cubeSize, 0, 1.f});
+    shape.vertices.push_back(position + (PointF){cubeSize, cubeSize, 0, 1.f});
+    shape.vertices.push_back(position + (PointF){-cubeSize, cubeSize, 0, 1.f});
 
-    shape.vertexIndex.emplace_back(std::array<uint32_t, 3>({vertexOffset + 0, vertexOffset + 2, vertexOffset + 1}));
+    shape.vertexIndex.emplace_back(std::array<uint32_t, 3>({vertexOffset + 0, vertexOffset + 1, vertexOffset + 2}));
     shape.normals.emplace_back(
         (shape.vertices[vertexOffset + 0] - shape.vertices[vertexOffset + 2]).cross((shape.vertices[vertexOffset + 0] - shape.vertices[vertexOffset + 1])).normalize());
     shape.normalIndex.emplace_back(shape.normals.size() - 1);
 
-    shape.vertexIndex.emplace_back(std::array<uint32_t, 3>({vertexOffset + 0, vertexOffset + 3, vertexOffset + 2}));
+    shape.vertexIndex.emplace_back(std::array<uint32_t, 3>({vertexOffset + 0, vertexOffset + 2, vertexOffset + 3}));
     shape.normals.emplace_back(
         (shape.vertices[vertexOffset + 0] - shape.vertices[vertexOffset + 3]).cross((shape.vertices[vertexOffset + 0] - shape.vertices[vertexOffset + 2])).normalize());
     shape.normalIndex.emplace_back(shape.normals.size() - 1);
 
     shape.transformedNormals.resize(shape.normals.size());
-    shape.transformedVertices.resize(shape.vertices.size());
-    shape.projectedVertices.resize(shape.vertices.size());
+    shape.updateBounds();
 
     shape.translate({0.f, 0.f, position.z});
 }
@@ -337,10 +185,10 @@ void Shape::appendWall(Shape &shape, float size, PointF position)
 {
     uint32_t vertexOffset = shape.vertices.size();
 
-    shape.vertices.emplace_back(position + (PointF){-size, -size, 0, 1.f});
-    shape.vertices.emplace_back(position + (PointF){size, -size, 0, 1.f});
-    shape.vertices.emplace_back(position + (PointF){size, size, 0, 1.f});
-    shape.vertices.emplace_back(position + (PointF){-size, size, 0, 1.f});
+    shape.vertices.push_back(position + (PointF){-size, -size, 0, 1.f});
+    shape.vertices.push_back(position + (PointF){size, -size, 0, 1.f});
+    shape.vertices.push_back(position + (PointF){size, size, 0, 1.f});
+    shape.vertices.push_back(position + (PointF){-size, size, 0, 1.f});
 
     shape.vertexIndex.emplace_back(std::array<uint32_t, 3>({vertexOffset + 0, vertexOffset + 2, vertexOffset + 1}));
     shape.normals.emplace_back((shape.vertices[vertexOffset + 0] - shape.vertices[vertexOffset + 1]).cross((shape.vertices[vertexOffset + 0] - shape.vertices[vertexOffset + 2])).normalize());
@@ -351,8 +199,7 @@ void Shape::appendWall(Shape &shape, float size, PointF position)
 
     shape.transformedNormals.resize(shape.normals.size());
 
-    shape.transformedVertices.resize(shape.vertices.size());
-    shape.projectedVertices.resize(shape.vertices.size());
+    shape.updateBounds();
 
     shape.translate({0.f, 0.f, position.z});
 }
@@ -360,15 +207,15 @@ void Shape::appendCube(Shape &shape, float cubeSize, PointF position)
 {
     uint32_t vertexOffset = shape.vertices.size();
 
-    shape.vertices.emplace_back(position + (PointF){-cubeSize, -cubeSize, cubeSize, 1.f});
-    shape.vertices.emplace_back(position + (PointF){cubeSize, -cubeSize, cubeSize, 1.f});
-    shape.vertices.emplace_back(position + (PointF){cubeSize, cubeSize, cubeSize, 1.f});
-    shape.vertices.emplace_back(position + (PointF){-cubeSize, cubeSize, cubeSize, 1.f});
+    shape.vertices.push_back(position + (PointF){-cubeSize, -cubeSize, cubeSize, 1.f});
+    shape.vertices.push_back(position + (PointF){cubeSize, -cubeSize, cubeSize, 1.f});
+    shape.vertices.push_back(position + (PointF){cubeSize, cubeSize, cubeSize, 1.f});
+    shape.vertices.push_back(position + (PointF){-cubeSize, cubeSize, cubeSize, 1.f});
 
-    shape.vertices.emplace_back(position + (PointF){-cubeSize, -cubeSize, -cubeSize, 1.f});
-    shape.vertices.emplace_back(position + (PointF){cubeSize, -cubeSize, -cubeSize, 1.f});
-    shape.vertices.emplace_back(position + (PointF){cubeSize, cubeSize, -cubeSize, 1.f});
-    shape.vertices.emplace_back(position + (PointF){-cubeSize, cubeSize, -cubeSize, 1.f});
+    shape.vertices.push_back(position + (PointF){-cubeSize, -cubeSize, -cubeSize, 1.f});
+    shape.vertices.push_back(position + (PointF){cubeSize, -cubeSize, -cubeSize, 1.f});
+    shape.vertices.push_back(position + (PointF){cubeSize, cubeSize, -cubeSize, 1.f});
+    shape.vertices.push_back(position + (PointF){-cubeSize, cubeSize, -cubeSize, 1.f});
 
     shape.vertexIndex.emplace_back(std::array<uint32_t, 3>({vertexOffset + 0, vertexOffset + 2, vertexOffset + 1}));
     shape.normals.emplace_back(
@@ -429,8 +276,7 @@ void Shape::appendCube(Shape &shape, float cubeSize, PointF position)
 
     shape.transformedNormals.resize(shape.normals.size());
 
-    shape.transformedVertices.resize(shape.vertices.size());
-    shape.projectedVertices.resize(shape.vertices.size());
+    shape.updateBounds();
 
     shape.translate({0.f, 0.f, position.z});
 }
@@ -489,8 +335,7 @@ Shape Shape::createCube(float cubeSize = 50, float zPosition = 140)
 
     shape.transformedNormals.resize(shape.normals.size());
 
-    shape.transformedVertices.resize(shape.vertices.size());
-    shape.projectedVertices.resize(shape.vertices.size());
+    shape.updateBounds();
 
     shape.translate({0.f, 0.f, zPosition});
 
@@ -512,6 +357,12 @@ bool sortTriangleX(PointI a, PointI b)
 void Shape::rasterizeTriangle(Triangle<int32_t> triangle, ImageData &pImageData)
 {
     std::sort(triangle.vertices.begin(), triangle.vertices.end(), sortTriangleY);
+    std::array<PointF, 3> points;
+    for (int i = 0; i < 3; i++)
+    {
+        points[i] = {(float)triangle.vertices[i].x, (float)triangle.vertices[i].y, (float)triangle.vertices[i].z};
+    }
+    DepthPlane depth = getDepthPlane(points, pImageData.nearPlane);
 
     float dy = (float)(triangle.vertices[1].y - triangle.vertices[0].y);
     float dx = (float)(triangle.vertices[2].y - triangle.vertices[0].y);
@@ -526,7 +377,7 @@ void Shape::rasterizeTriangle(Triangle<int32_t> triangle, ImageData &pImageData)
         int localStart = floor(start);
         int localEnd = floor(end);
 
-        pImageData.drawLineZ({triangle.vertices[0].x + localStart, triangle.vertices[0].y + i}, {triangle.vertices[0].x + localEnd, triangle.vertices[0].y + i}, triangle.vertices, triangle.color);
+        pImageData.drawLineZ({triangle.vertices[0].x + localStart, triangle.vertices[0].y + i}, {triangle.vertices[0].x + localEnd, triangle.vertices[0].y + i}, depth, triangle.color);
 
         start += incrementXLimit;
         end += incrementY;
@@ -550,7 +401,7 @@ void Shape::rasterizeTriangle(Triangle<int32_t> triangle, ImageData &pImageData)
     {
         int localStart = floor(start);
         int localEnd = floor(end);
-        pImageData.drawLineZ({triangle.vertices[0].x + localStart, triangle.vertices[1].y + i}, {triangle.vertices[0].x + localEnd, triangle.vertices[1].y + i}, triangle.vertices, triangle.color);
+        pImageData.drawLineZ({triangle.vertices[0].x + localStart, triangle.vertices[1].y + i}, {triangle.vertices[0].x + localEnd, triangle.vertices[1].y + i}, depth, triangle.color);
         start += incrementXLimit;
         end += incrementY;
     }
@@ -562,13 +413,14 @@ void Shape::appendCircle(Shape &shape, float radius, int sides, PointF position)
 {
     float phaseIncrement = 3.1416 / sides;
     float phase = 0;
-    shape.vertices.emplace_back(position);
+    shape.vertices.push_back(position);
     for (int i = 0; i < sides; i++)
     {
         PointF vertex = {static_cast<float>(sin(phase) * radius), 0, static_cast<float>(cos(phase) * radius)};
         phase += phaseIncrement;
-        shape.vertices.emplace_back(vertex);
+        shape.vertices.push_back(vertex);
     }
     shape.normals.push_back({0.f, 1.f, 0.f, 0.f});
     shape.normalIndex.emplace_back(shape.normals.size() - 1);
+    shape.updateBounds();
 }
@@ -1,49 +1,64 @@
 #pragma once
 #include <vector>
 #include <array>
+#include <memory>
+#include <string>
 #include "../../core/math/mathUtils.hpp"
+#include "../../core/math/bounds/bounds.hpp"
+#include "../../core/math/vertexStream/vertexStream.hpp"
+#include "../../core/math/vertexStream/meshArray.hpp"
+#include "../../core/meshFile/meshFile.hpp"
 #include "../../core/graphics/imageData/imagedata.hpp"
-#include "../camera/camera.hpp"
 #include "../object3D/object3d.hpp"
-#include <functional>
+
+// a level only changes once the screen size is this much past its threshold
+#define LOD_HYSTERESIS 0.15f
 
 class Shape : public Object3D
 {
-    bool isBackFace(PointF normal, PointF vector);
     static bool sortTriangleZ(PointF a, PointF b);
     static bool sortTriangleX(PointF a, PointF b);
     static bool sortTriangleXRight(PointF a, PointF b);
     void transform();
+    // keeps a loaded mesh mapped, the geometry arrays point into it
+    std::shared_ptr<MeshFile> meshFile;
 
 public:
     Color difuseColor;
-    std::vector<PointF> vertices;
-    std::vector<PointF> normals;
-    std::vector<std::array<uint32_t, 3>> vertexIndex;
-    std::vector<uint32_t> normalIndex;
-    std::vector<PointF> transformedVertices;
+    VertexStream vertices;
+    MeshArray<PointF> normals;
+    // front faces are wound so that (b - a) x (c - a) points against their outward normal
+    MeshArray<std::array<uint32_t, 3>> vertexIndex;
+    MeshArray<uint32_t> normalIndex;
+    // one per face when set, otherwise every face is difuseColor
+    std::vector<Color> faceColors;
     std::vector<PointF> transformedNormals;
-    std::vector<PointF> projectedVertices;
+
+    // model space, kept up to date by the append* builders
+    BoundingBox bounds = {{0}, {0}};
+    BoundingSphere boundingSphere = {{0}, 0};
+    // world space, refreshed by update()
+    BoundingBox worldBounds = {{0}, {0}};
+    BoundingSphere worldBoundingSphere = {{0}, 0};
+
+    // Coarser meshes, lodMeshes[i] is drawn while the bounding sphere covers less than
+    // lodSizes[i] pixels on screen. They share the transform and bounds of this shape.
+    std::vector<Shape> lodMeshes;
+    std::vector<float> lodSizes;
+    // 0 is this mesh, i is lodMeshes[i - 1]
+    int32_t lodLevel = 0;
 
     Shape(int vertexNum);
     ~Shape();
 
-    void draw(ImageData &pImageData, Camera camera);
     void update(void);
+    void updateBounds(void);
+    void addLod(const Shape &mesh, float screenSize);
+    Shape &selectLod(float screenSize);
 
-    void project(float distance);
-    void project(TrianglesI &pProjectedVertices, TrianglesF &triangles, float distance);
-
-    void rasterizeTriangle(Triangle<int32_t> triangle, ImageData &pImageData);
-    void clipTriangleGeneric(TrianglesF &triangles,
-                             TriangleF triangle,
-                             float boundary,
-                             std::vector<uint32_t> &localNormalIndex,
-                             int32_t normalIndex,
-                             std::function<bool(PointF, float)> compareFunc,
-                             std::function<bool(PointF, PointF)> sortFunc,
-                             PointF planeNormal,
-                             PointF planePoint);
+    // the geometry is read in place from the file, which stays mapped while any copy uses it
+    static bool loadMesh(Shape &shape, const std::string &path);
+    static void rasterizeTriangle(Triangle<int32_t> triangle, ImageData &pImageData);
 
     static Shape createCube(float cubeSize, float zPosition);
     static Shape createPyramid(float baseSize = 50, float height = 50, float zPosition = 140);
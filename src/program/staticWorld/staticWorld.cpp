@@ -0,0 +1,48 @@
+#include "staticWorld.hpp"
+#include <cmath>
+
+Shape &StaticWorld::chunkAt(PointF position)
+{
+    PointI cell = {static_cast<int32_t>(floorf(position.x / STATIC_CHUNK_SIZE)),
+                   static_cast<int32_t>(floorf(position.y / STATIC_CHUNK_SIZE)),
+                   static_cast<int32_t>(floorf(position.z / STATIC_CHUNK_SIZE))};
+    for (auto &chunk : chunks)
+    {
+        if (chunk.cell.x == cell.x && chunk.cell.y == cell.y && chunk.cell.z == cell.z)
+            return chunk.shape;
+    }
+
+    chunks.push_back({cell, Shape(0)});
+    return chunks.back().shape;
+}
+
+void StaticWorld::add(Shape &shape)
+{
+    shape.update();
+    Shape &chunk = chunkAt(shape.worldBoundingSphere.center);
+
+    uint32_t vertexOffset = chunk.vertices.size();
+    uint32_t normalOffset = chunk.normals.size();
+    for (size_t i = 0; i < shape.vertices.size(); i++)
+    {
+        PointF local = shape.vertices[i];
+        PointF world;
+        MathUtils::multiplyVertexByMatrix(world, local, shape.transformMatrix);
+        chunk.vertices.push_back(world);
+    }
+    for (auto &normal : shape.transformedNormals)
+    {
+        chunk.normals.push_back(normal);
+    }
+    for (size_t i = 0; i < shape.vertexIndex.size(); i++)
+    {
+        auto index = shape.vertexIndex[i];
+        chunk.vertexIndex.push_back({index[0] + vertexOffset, index[1] + vertexOffset, index[2] + vertexOffset});
+        chunk.normalIndex.push_back(shape.normalIndex[i] + normalOffset);
+        chunk.faceColors.push_back(shape.faceColors.empty() ? shape.difuseColor : shape.faceColors[i]);
+    }
+
+    chunk.transformedNormals.resize(chunk.normals.size());
+    chunk.updateBounds();
+    chunk.update();
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include "../shape/shape.hpp"
+
+// edge of the world space cells static shapes are grouped by
+#define STATIC_CHUNK_SIZE 1024.f
+
+typedef struct
+{
+    PointI cell;
+    Shape shape;
+} StaticChunk;
+
+// Shapes that never move are baked once into world space chunks. A chunk is a Shape with an
+// identity transform and per face colours, it is culled like any other shape and costs no
+// model transform. A shape goes whole into the chunk of its bounding sphere centre.
+class StaticWorld
+{
+public:
+    std::vector<StaticChunk> chunks;
+
+    void add(Shape &shape);
+
+private:
+    Shape &chunkAt(PointF position);
+};
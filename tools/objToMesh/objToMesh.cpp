@@ -0,0 +1,114 @@
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../../src/core/meshFile/meshFile.hpp"
+
+// Converts a Wavefront OBJ file to the mesh format of Shape::loadMesh. Only positions and faces
+// are read, polygons are split into fans and every triangle gets its face normal. OBJ is x right,
+// y up and z towards the viewer, the renderer is x right, y down and z forward, so positions are
+// rotated half a turn about x to (x, -y, -z). A rotation keeps the counter clockwise order of the
+// front faces, the fans are emitted reversed so that (b - a) x (c - a) points against the
+// outward normal as Shape expects. The face normals come from the rotated positions.
+
+static bool parseIndex(const std::string &token, size_t vertexCount, uint32_t &index)
+{
+    int64_t value;
+    try
+    {
+        value = std::stoll(token.substr(0, token.find('/')));
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+
+    // negative indices count back from the last vertex
+    value = value < 0 ? (int64_t)vertexCount + value : value - 1;
+    if (value < 0 || value >= (int64_t)vertexCount)
+        return false;
+
+    index = (uint32_t)value;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cout << "usage: objToMesh input.obj output.mesh" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input(argv[1]);
+    if (!input)
+    {
+        std::cout << "could not open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<PointF> vertices;
+    std::vector<PointF> normals;
+    std::vector<std::array<uint32_t, 3>> vertexIndex;
+    std::vector<uint32_t> normalIndex;
+
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(input, line); lineNumber++)
+    {
+        std::istringstream stream(line);
+        std::string type;
+        stream >> type;
+
+        if (type == "v")
+        {
+            PointF vertex = {0, 0, 0, 1.f};
+            if (!(stream >> vertex.x >> vertex.y >> vertex.z))
+            {
+                std::cout << argv[1] << ":" << lineNumber << ": bad vertex" << std::endl;
+                return 1;
+            }
+            vertex.y = -vertex.y;
+            vertex.z = -vertex.z;
+            vertices.push_back(vertex);
+        }
+        else if (type == "f")
+        {
+            std::vector<uint32_t> polygon;
+            std::string token;
+            while (stream >> token)
+            {
+                uint32_t index;
+                if (!parseIndex(token, vertices.size(), index))
+                {
+                    std::cout << argv[1] << ":" << lineNumber << ": bad face index " << token << std::endl;
+                    return 1;
+                }
+                polygon.push_back(index);
+            }
+
+            for (size_t i = 2; i < polygon.size(); i++)
+            {
+                std::array<uint32_t, 3> triangle = {polygon[0], polygon[i], polygon[i - 1]};
+                PointF a = vertices[triangle[0]];
+                PointF normal = (vertices[triangle[1]] - a).cross(vertices[triangle[2]] - a);
+                if (normal.dot(normal) == 0)
+                    continue;
+
+                normals.push_back(normal.scale(-1.f).normalize());
+                vertexIndex.push_back(triangle);
+                normalIndex.push_back(normals.size() - 1);
+            }
+        }
+    }
+
+    if (!MeshFile::write(argv[2], vertices, normals, vertexIndex, normalIndex))
+    {
+        std::cout << "could not write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << vertices.size() << " vertices, " << vertexIndex.size() << " triangles" << std::endl;
+    return 0;
+}